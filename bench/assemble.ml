@@ -0,0 +1,59 @@
+(* Compare assembling a CSR matrix from COO triples in OCaml with
+   Sparse.to_csr, on one thread and on all of them.
+
+   usage: assemble.exe [rows] [columns] [nonzeros] [repetitions] *)
+
+open Guroobi
+open Utils
+open Common
+
+(* a counting sort by rows, as user code would write it *)
+let ocaml_csr ~m ~num ~row ~col ~value : Raw.compressed =
+  let xbeg = i32a m and xind = i32a num and xval = fa num in
+  let next = Array.make (m + 1) 0 in
+  for k = 0 to num - 1 do
+    let i = Int32.to_int row.{k} + 1 in
+    next.(i) <- next.(i) + 1
+  done;
+  for i = 1 to m do
+    next.(i) <- next.(i) + next.(i - 1)
+  done;
+  for i = 0 to m - 1 do
+    xbeg.{i} <- Int32.of_int next.(i)
+  done;
+  for k = 0 to num - 1 do
+    let i = Int32.to_int row.{k} in
+    xind.{next.(i)} <- col.{k};
+    xval.{next.(i)} <- value.{k};
+    next.(i) <- next.(i) + 1
+  done;
+  { num_nz = num; xbeg; xind; xval }
+
+let () =
+  let m = int_arg 1 1_000_000 in
+  let n = int_arg 2 1_000_000 in
+  let num = int_arg 3 20_000_000 in
+  let repetitions = int_arg 4 3 in
+  let rng = Random.State.make [| 42 |] in
+  let row = i32a num and col = i32a num and value = fa num in
+  for k = 0 to num - 1 do
+    row.{k} <- Int32.of_int (Random.State.int rng m);
+    col.{k} <- Int32.of_int (Random.State.int rng n);
+    value.{k} <- Random.State.float rng 1.0
+  done;
+  pr "%d rows, %d columns, %d nonzeros, %d repetitions\n" m n num repetitions;
+
+  measure "ocaml" repetitions (fun () ->
+      ignore (ocaml_csr ~m ~num ~row ~col ~value));
+  List.iter
+    (fun (label, threads, merge) ->
+      measure label repetitions (fun () ->
+          ignore
+            (Sparse.to_csr ~threads ~merge ~num_rows:m ~num_cols:n ~num ~row
+               ~col ~value ())))
+    [
+      ("to_csr, 1 thread", 1, false);
+      ("to_csr, all threads", 0, false);
+      ("to_csr merge, 1 thread", 1, true);
+      ("to_csr merge, all threads", 0, true);
+    ]
@@ -0,0 +1,24 @@
+(* Compare reading a variable attribute array into a fresh bigarray on
+   every call with reading it into a reused one.
+
+   usage: attr_into.exe [model-file] [iterations] *)
+
+open Guroobi
+open Raw
+open Utils
+open Common
+
+let () =
+  let path, iterations = args ~default_iterations:100_000 in
+  let model = solved_model path in
+  let len = eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numvars) in
+  let name = GRB.dbl_attr_x in
+  pr "%s: %d variables, %d iterations\n" path len iterations;
+
+  measure "get_float_attr_array" iterations (fun () ->
+      ignore (eer "get" (get_float_attr_array ~model ~name ~start:0 ~len)));
+
+  let dst = fa len in
+  measure "get_float_attr_array_into" iterations (fun () ->
+      assert (
+        get_float_attr_array_into ~model ~name ~start:0 ~len ~dst ~offset:0 = 0))
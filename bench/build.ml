@@ -0,0 +1,163 @@
+(* How the cost of building a model grows with its size: the time taken, and
+   the resident memory afterwards, to build synthetic models (see gen.ml)
+   through each path, then to optimize them.
+
+   usage: build.exe [models] [sizes] [paths] [time-limit]
+
+   where [models] is a comma-separated list of facility, workforce and
+   multiscenario; [sizes] a comma-separated list of approximate numbers of
+   variables; and [paths] a comma-separated list of:
+   - element: add_var and add_constr, one variable or constraint at a time
+   - batched: new_model with all the variables, then a single add_constrs
+   - lin: new_model, then the constraints through the Lin builder
+   - load: a single load_model
+   - optimize: load_model, then optimize, for at most [time-limit] seconds
+
+   The defaults (all the models, 1000 variables, all the paths, 10 seconds)
+   fit within the limits of a size-limited license. With GUROOBI_INSTRUMENT
+   set, the counters of the stubs are printed as JSON on the standard error.
+   *)
+
+open Guroobi
+open Raw
+open Common
+
+let list_arg i default =
+  if Array.length Sys.argv > i then String.split_on_char ',' Sys.argv.(i)
+  else default
+
+let ok fname code = if code <> 0 then eer fname (Error code)
+
+let empty_model env (g : Gen.t) ~num_vars =
+  eer "new_model"
+    (new_model ~env ~name:(Some g.name) ~num_vars
+       ~objective:(if num_vars = 0 then None else Some g.obj)
+       ~lower_bound:(if num_vars = 0 then None else Some g.lb)
+       ~upper_bound:(if num_vars = 0 then None else Some g.ub)
+       ~var_type:(if num_vars = 0 then None else Some g.vtype)
+       ~var_name:None)
+
+let element env (g : Gen.t) (csr : compressed) =
+  let model = empty_model env g ~num_vars:0 in
+  for j = 0 to g.num_vars - 1 do
+    ok "add_var"
+      (add_var ~model ~num_nz:0 ~v_ind:None ~v_val:None ~obj:g.obj.{j}
+         ~lb:g.lb.{j} ~ub:g.ub.{j} ~v_type:g.vtype.{j} ~var_name:None)
+  done;
+  for i = 0 to g.num_constrs - 1 do
+    let first = Int32.to_int csr.xbeg.{i} in
+    let last =
+      if i = g.num_constrs - 1 then csr.num_nz
+      else Int32.to_int csr.xbeg.{i + 1}
+    in
+    let num_nz = last - first in
+    ok "add_constr"
+      (add_constr ~model ~num_nz
+         ~var_index:(Bigarray.Array1.sub csr.xind first num_nz)
+         ~nz:(Bigarray.Array1.sub csr.xval first num_nz)
+         ~sense:g.sense.{i} ~rhs:g.rhs.{i} ~name:None)
+  done;
+  model
+
+let batched env (g : Gen.t) csr =
+  let model = empty_model env g ~num_vars:g.num_vars in
+  ok "add_constrs"
+    (add_constrs ~model ~num:g.num_constrs ~matrix:(Some csr) ~sense:g.sense
+       ~rhs:g.rhs ~name:None);
+  model
+
+let lin env (g : Gen.t) (csr : compressed) =
+  let model = empty_model env g ~num_vars:g.num_vars in
+  let b = Lin.create model in
+  for i = 0 to g.num_constrs - 1 do
+    let last =
+      if i = g.num_constrs - 1 then csr.num_nz
+      else Int32.to_int csr.xbeg.{i + 1}
+    in
+    for k = Int32.to_int csr.xbeg.{i} to last - 1 do
+      Lin.term b (Int32.to_int csr.xind.{k}) csr.xval.{k}
+    done;
+    Lin.row b g.sense.{i} g.rhs.{i}
+  done;
+  Lin.flush b;
+  model
+
+let load env (g : Gen.t) csc =
+  eer "load_model"
+    (load_model ~env ~name:(Some g.name) ~num_vars:g.num_vars
+       ~num_constrs:g.num_constrs ~obj_sense:GRB.minimize ~obj_con:0.0
+       ~objective:(Some g.obj) ~sense:g.sense ~rhs:g.rhs ~matrix:csc
+       ~lower_bound:(Some g.lb) ~upper_bound:(Some g.ub)
+       ~var_type:(Some g.vtype) ~var_name:None ~constr_name:None)
+
+let time f =
+  let t0 = Unix.gettimeofday () in
+  let x = f () in
+  (x, Unix.gettimeofday () -. t0)
+
+let report (g : Gen.t) label seconds extra =
+  pr "%-14s %10d %10d %12d  %-9s %9.3f s %7d MiB%s\n%!" g.name g.num_vars
+    g.num_constrs g.num_nz label seconds (rss_mib ()) extra
+
+let () =
+  let models = list_arg 1 [ "facility"; "workforce"; "multiscenario" ] in
+  let sizes = List.map int_of_string (list_arg 2 [ "1000" ]) in
+  let paths = list_arg 3 [ "element"; "batched"; "lin"; "load"; "optimize" ] in
+  let time_limit =
+    if Array.length Sys.argv > 4 then float_of_string Sys.argv.(4) else 10.0
+  in
+  let env = quiet_env () in
+  ok "set_float_param"
+    (set_float_param ~env ~name:GRB.dbl_par_timelimit ~value:time_limit);
+  pr "%-14s %10s %10s %12s  %-9s %11s %11s\n" "model" "variables"
+    "constraints" "nonzeros" "path" "time" "rss";
+  List.iter
+    (fun name ->
+      List.iter
+        (fun size ->
+          let g, seconds = time (fun () -> Gen.of_name name ~size) in
+          report g "generate" seconds "";
+          let num_rows = g.num_constrs and num_cols = g.num_vars in
+          let (csr, csc), seconds =
+            time (fun () ->
+                ( Sparse.to_csr ~num_rows ~num_cols ~num:g.num_nz ~row:g.row
+                    ~col:g.col ~value:g.value (),
+                  Sparse.to_csc64 ~num_rows ~num_cols ~num:g.num_nz ~row:g.row
+                    ~col:g.col ~value:g.value () ))
+          in
+          report g "assemble" seconds "";
+          let build label f =
+            Gc.compact ();
+            let model, seconds =
+              time (fun () ->
+                  let model = f () in
+                  ok "update_model" (update_model ~model);
+                  model)
+            in
+            report g label seconds "";
+            free_model model
+          in
+          List.iter
+            (function
+              | "element" -> build "element" (fun () -> element env g csr)
+              | "batched" -> build "batched" (fun () -> batched env g csr)
+              | "lin" -> build "lin" (fun () -> lin env g csr)
+              | "load" -> build "load" (fun () -> load env g csc)
+              | "optimize" ->
+                  let model = load env g csc in
+                  let code, seconds = time (fun () -> optimize model) in
+                  let extra =
+                    if code <> 0 then Printf.sprintf "  error %d" code
+                    else
+                      match get_int_attr ~model ~name:GRB.int_attr_status with
+                      | Ok status -> Printf.sprintf "  status %d" status
+                      | Error code -> Printf.sprintf "  error %d" code
+                  in
+                  report g "optimize" seconds extra;
+                  free_model model
+              | path -> invalid_arg ("unknown path " ^ path))
+            paths)
+        sizes)
+    models;
+  if Instrument.enabled () then
+    prerr_endline (Instrument.to_string (Instrument.snapshot ()))
@@ -0,0 +1,144 @@
+(* helpers shared by the benchmarks *)
+
+open Guroobi
+open Raw
+open Utils
+
+let pr = Printf.printf
+
+let eer fname = function
+  | Ok v -> v
+  | Error code ->
+      pr "%s failed with error %d\n" fname code;
+      exit 1
+
+(* run [f] [iterations] times, and return the time, in nanoseconds, and the
+   number of words allocated on the minor heap, per call *)
+let sample iterations f =
+  Gc.full_major ();
+  let words0 = Gc.minor_words () in
+  let t0 = Unix.gettimeofday () in
+  for _ = 1 to iterations do
+    f ()
+  done;
+  let t1 = Unix.gettimeofday () in
+  let words = Gc.minor_words () -. words0 in
+  ((t1 -. t0) *. 1e9 /. float iterations, words /. float iterations)
+
+(* run [f] [iterations] times, and report the time and the number of words
+   allocated on the minor heap per call *)
+let measure label iterations f =
+  let ns, words = sample iterations f in
+  pr "%-28s %10.1f ns/call %8.2f minor words/call\n" label ns words
+
+(* [model-file] and [iterations] from the command line *)
+let args ~default_iterations =
+  let path =
+    if Array.length Sys.argv > 1 then Sys.argv.(1) else "test/data/stein9.mps"
+  in
+  let iterations =
+    if Array.length Sys.argv > 2 then int_of_string Sys.argv.(2)
+    else default_iterations
+  in
+  (path, iterations)
+
+(* a started environment that does not log *)
+let quiet_env () =
+  let env = eer "empty_env" (empty_env ()) in
+  assert (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0 = 0);
+  assert (start_env env = 0);
+  env
+
+(* the model read from [path], optimized *)
+let solved_model path =
+  let env = quiet_env () in
+  let model =
+    match read_model ~env ~path with
+    | Ok m -> m
+    | FileNotFound ->
+        pr "unable to open %s\n" path;
+        exit 1
+    | Error code -> eer "read_model" (Error code)
+  in
+  assert (optimize model = 0);
+  model
+
+(* the [i]-th command line argument, an int, if given *)
+let int_arg i default =
+  if Array.length Sys.argv > i then int_of_string Sys.argv.(i) else default
+
+type lp = {
+  m : int;  (** rows *)
+  n : int;  (** columns *)
+  num_nz : int;
+  csc : compressed64;  (** the matrix by columns *)
+  csr : compressed;  (** the same matrix by rows *)
+  objective : fa;
+  sense : ca;
+  rhs : fa;
+}
+
+(* a random covering LP with [m] rows and [n] columns, with [k] distinct rows
+   per column; the same for the same arguments *)
+let random_lp ~m ~n ~k =
+  let k = min m k in
+  let rng = Random.State.make [| 42 |] in
+  let num_nz = n * k in
+  let csc : compressed64 =
+    { num_nz; xbeg = i64a n; xind = i32a num_nz; xval = fa num_nz }
+  in
+  for j = 0 to n - 1 do
+    csc.xbeg.{j} <- Int64.of_int (j * k);
+    let first = Random.State.int rng m in
+    for t = 0 to k - 1 do
+      csc.xind.{(j * k) + t} <- Int32.of_int ((first + (t * (m / k))) mod m);
+      csc.xval.{(j * k) + t} <- 1.0 +. Random.State.float rng 9.0
+    done
+  done;
+
+  let row_len = Array.make m 0 in
+  for p = 0 to num_nz - 1 do
+    let i = Int32.to_int csc.xind.{p} in
+    row_len.(i) <- row_len.(i) + 1
+  done;
+  let csr = { num_nz; xbeg = i32a m; xind = i32a num_nz; xval = fa num_nz } in
+  let next = Array.make m 0 in
+  let pos = ref 0 in
+  for i = 0 to m - 1 do
+    csr.xbeg.{i} <- Int32.of_int !pos;
+    next.(i) <- !pos;
+    pos := !pos + row_len.(i)
+  done;
+  for j = 0 to n - 1 do
+    for p = j * k to ((j + 1) * k) - 1 do
+      let i = Int32.to_int csc.xind.{p} in
+      csr.xind.{next.(i)} <- Int32.of_int j;
+      csr.xval.{next.(i)} <- csc.xval.{p};
+      next.(i) <- next.(i) + 1
+    done
+  done;
+
+  let objective = fa n in
+  for j = 0 to n - 1 do
+    objective.{j} <- Random.State.float rng 1.0
+  done;
+  let sense = ca m in
+  Bigarray.Array1.fill sense GRB.greater_equal;
+  let rhs = fa m in
+  Bigarray.Array1.fill rhs 1.0;
+  { m; n; num_nz; csc; csr; objective; sense; rhs }
+
+(* [load_lp env lp] is a model of [lp] *)
+let load_lp env lp =
+  eer "load_model"
+    (load_model ~env ~name:None ~num_vars:lp.n ~num_constrs:lp.m
+       ~obj_sense:GRB.minimize ~obj_con:0.0 ~objective:(Some lp.objective)
+       ~sense:lp.sense ~rhs:lp.rhs ~matrix:lp.csc ~lower_bound:None
+       ~upper_bound:None ~var_type:None ~var_name:None ~constr_name:None)
+
+(* resident set size of this process, in MiB *)
+let rss_mib () =
+  let ic = open_in "/proc/self/statm" in
+  let line = input_line ic in
+  close_in ic;
+  Scanf.sscanf line "%_d %d" (fun pages -> pages * 4096 / (1024 * 1024))
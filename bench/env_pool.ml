@@ -0,0 +1,57 @@
+(* Compare starting an environment for each request against taking one from
+   an Env_pool. A request reads a model and optimizes it, with [threads]
+   requests in flight at once.
+
+   usage: env_pool.exe [model-file] [requests] [threads] *)
+
+open Guroobi
+open Raw
+open Common
+
+let solve ~env path =
+  match read_model ~env ~path with
+  | Ok model -> assert (optimize model = 0)
+  | FileNotFound ->
+      pr "unable to open %s\n" path;
+      exit 1
+  | Error code -> eer "read_model" (Error code)
+
+let quiet env =
+  assert (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0 = 0)
+
+(* run [requests] calls of [f], spread over [threads] threads *)
+let in_parallel ~threads ~requests f =
+  let next = ref 0 and mutex = Mutex.create () in
+  let take () =
+    Mutex.lock mutex;
+    let i = !next in
+    incr next;
+    Mutex.unlock mutex;
+    i < requests
+  in
+  let rec worker () =
+    if take () then (
+      f ();
+      worker ())
+  in
+  List.init threads (fun _ -> Thread.create worker ()) |> List.iter Thread.join
+
+let timed label ~threads ~requests f =
+  let t0 = Unix.gettimeofday () in
+  in_parallel ~threads ~requests f;
+  let t1 = Unix.gettimeofday () in
+  pr "%-28s %10.3f ms/request\n" label ((t1 -. t0) *. 1e3 /. float requests)
+
+let () =
+  let path, requests = args ~default_iterations:50 in
+  let threads = int_arg 3 4 in
+  pr "%s, %d requests, %d threads\n" path requests threads;
+
+  timed "fresh environment" ~threads ~requests (fun () ->
+      let env = quiet_env () in
+      solve ~env path);
+
+  let pool = Env_pool.create ~baseline:quiet ~size:threads () in
+  timed "pooled environment" ~threads ~requests (fun () ->
+      Env_pool.with_env pool (fun env -> solve ~env path));
+  Env_pool.close pool
@@ -0,0 +1,178 @@
+(* The cost of each class of stubs, in ns/call and minor words/call, on the
+   models in test/data, as JSON on the standard output, e.g. to compare
+   against the results of a previous release.
+
+   usage: ffi.exe [iterations] [model-file ...] *)
+
+open Guroobi
+open Raw
+open Utils
+open Common
+
+let ok fname code = if code <> 0 then eer fname (Error code)
+
+type result = {
+  model : string;
+  name : string;
+  iterations : int;
+  ns_per_call : float;
+  minor_words_per_call : float;
+}
+
+let to_json r =
+  `Assoc
+    [
+      ("model", `String r.model);
+      ("name", `String r.name);
+      ("iterations", `Int r.iterations);
+      ("ns_per_call", `Float r.ns_per_call);
+      ("minor_words_per_call", `Float r.minor_words_per_call);
+    ]
+
+(* the benchmarks of [path]; each call of the function given to [case] is
+   one call of the stub measured *)
+let run_model ~iterations path =
+  let results = ref [] in
+  let model_name = Filename.remove_extension (Filename.basename path) in
+  let case ?(iterations = iterations) name f =
+    let ns, words = sample iterations f in
+    results :=
+      {
+        model = model_name;
+        name;
+        iterations;
+        ns_per_call = ns;
+        minor_words_per_call = words;
+      }
+      :: !results
+  in
+  let model = solved_model path in
+  let env = quiet_env () in
+  let n = eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numvars) in
+  let next =
+    let i = ref 0 in
+    fun () ->
+      i := (!i + 1) mod n;
+      !i
+  in
+
+  (* scalar attributes and parameters *)
+  case "get_int_attr" (fun () ->
+      ignore (get_int_attr ~model ~name:GRB.int_attr_numvars));
+  let err = i32a 1 in
+  case "Fast.get_int_attr" (fun () ->
+      ignore (Fast.get_int_attr ~model ~name:GRB.int_attr_numvars ~err));
+  case "get_float_attr" (fun () ->
+      ignore (get_float_attr ~model ~name:GRB.dbl_attr_objval));
+  case "get_int_param" (fun () ->
+      ignore (get_int_param ~env ~name:GRB.int_par_threads));
+  case "set_int_param" (fun () ->
+      ok "set_int_param"
+        (set_int_param ~env ~name:GRB.int_par_threads ~value:0));
+  case "get_float_param" (fun () ->
+      ignore (get_float_param ~env ~name:GRB.dbl_par_mipgap));
+
+  (* elements of attribute arrays, one by one *)
+  case "get_float_attr_element" (fun () ->
+      ignore
+        (get_float_attr_element ~model ~name:GRB.dbl_attr_x ~index:(next ())));
+  case "Fast.get_float_attr_element" (fun () ->
+      ignore
+        (Fast.get_float_attr_element ~model ~name:GRB.dbl_attr_x
+           ~index:(next ()) ~err));
+  case "set_float_attr_element" (fun () ->
+      ok "set_float_attr_element"
+        (set_float_attr_element ~model ~name:GRB.dbl_attr_obj ~index:(next ())
+           ~value:1.0));
+  case "get_char_attr_element" (fun () ->
+      ignore
+        (get_char_attr_element ~model ~name:GRB.char_attr_vtype
+           ~index:(next ())));
+
+  (* whole attribute arrays *)
+  case "get_float_attr_array" (fun () ->
+      ignore
+        (get_float_attr_array ~model ~name:GRB.dbl_attr_x ~start:0 ~len:n));
+  let dst = fa n in
+  case "get_float_attr_array_into" (fun () ->
+      ok "get_float_attr_array_into"
+        (get_float_attr_array_into ~model ~name:GRB.dbl_attr_x ~start:0 ~len:n
+           ~dst ~offset:0));
+  let ind = to_i32a (Array.init n Fun.id) in
+  case "get_float_attr_list" (fun () ->
+      ok "get_float_attr_list"
+        (get_float_attr_list ~model ~name:GRB.dbl_attr_x ~num:n ~ind
+           ~values:dst));
+  case "get_str_attr_array" (fun () ->
+      ignore
+        (get_str_attr_array ~model ~name:GRB.str_attr_varname ~start:0 ~len:n));
+  case "get_str_attr_array_packed" (fun () ->
+      ignore
+        (get_str_attr_array_packed ~model ~name:GRB.str_attr_varname ~start:0
+           ~len:n));
+  let obj = fa n in
+  Bigarray.Array1.fill obj 1.0;
+  case "set_float_attr_array" (fun () ->
+      ok "set_float_attr_array"
+        (set_float_attr_array ~model ~name:GRB.dbl_attr_obj ~start:0 ~len:n
+           ~values:obj));
+
+  (* adding constraints, to a copy of the model, which grows as they are
+     added: one per add_constr, and 100 per add_constrs *)
+  let copy () =
+    match copy_model ~model with
+    | Some copy -> copy
+    | None -> eer "copy_model" (Error GRB.error_out_of_memory)
+  in
+  let k = min n 10 in
+  let var_index = to_i32a (Array.init k Fun.id) in
+  let nz = fa k in
+  Bigarray.Array1.fill nz 1.0;
+  let target = copy () in
+  case "add_constr" (fun () ->
+      ok "add_constr"
+        (add_constr ~model:target ~num_nz:k ~var_index ~nz
+           ~sense:GRB.less_equal ~rhs:1.0 ~name:None));
+  free_model target;
+  let rows = 100 in
+  let matrix : compressed =
+    {
+      num_nz = rows * k;
+      xbeg = to_i32a (Array.init rows (fun i -> i * k));
+      xind = to_i32a (Array.init (rows * k) (fun p -> p mod k));
+      xval = to_fa (Array.make (rows * k) 1.0);
+    }
+  in
+  let sense = to_ca (Array.make rows GRB.less_equal) in
+  let rhs = to_fa (Array.make rows 1.0) in
+  let target = copy () in
+  case ~iterations:(max 1 (iterations / rows)) "add_constrs (100 rows)"
+    (fun () ->
+      ok "add_constrs"
+        (add_constrs ~model:target ~num:rows ~matrix:(Some matrix) ~sense ~rhs
+           ~name:None));
+  free_model target;
+
+  (* copying *)
+  case ~iterations:(max 1 (iterations / 100)) "copy_model" (fun () ->
+      free_model (copy ()));
+
+  List.rev !results
+
+let () =
+  let iterations =
+    if Array.length Sys.argv > 1 then int_of_string Sys.argv.(1) else 100_000
+  in
+  let paths =
+    if Array.length Sys.argv > 2 then
+      Array.to_list (Array.sub Sys.argv 2 (Array.length Sys.argv - 2))
+    else [ "test/data/stein9.mps"; "test/data/qafiro.mps" ]
+  in
+  let results = List.concat (List.map (run_model ~iterations) paths) in
+  Yojson.Basic.pretty_to_channel stdout
+    (`Assoc
+      [
+        ("ocaml_version", `String Sys.ocaml_version);
+        ("benchmarks", `List (List.map to_json results));
+      ]);
+  print_newline ()
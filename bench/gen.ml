@@ -0,0 +1,186 @@
+(* Synthetic models, shaped like those of test/facility.ml,
+   test/workforce1.ml and test/multiscenario.ml, of any size *)
+
+open Guroobi
+open Utils
+
+type t = {
+  name : string;
+  num_vars : int;
+  obj : Raw.fa;
+  lb : Raw.fa;
+  ub : Raw.fa;
+  vtype : Raw.ca;
+  num_constrs : int;
+  sense : Raw.ca;
+  rhs : Raw.fa;
+  (* the constraint matrix, as triples *)
+  num_nz : int;
+  row : Raw.i32a;
+  col : Raw.i32a;
+  value : Raw.fa;
+}
+
+(* triples, added one at a time *)
+type triples = {
+  t_row : Raw.i32a;
+  t_col : Raw.i32a;
+  t_value : Raw.fa;
+  mutable n : int;
+}
+
+let triples num_nz =
+  { t_row = i32a num_nz; t_col = i32a num_nz; t_value = fa num_nz; n = 0 }
+
+let add t i j v =
+  t.t_row.{t.n} <- Int32.of_int i;
+  t.t_col.{t.n} <- Int32.of_int j;
+  t.t_value.{t.n} <- v;
+  t.n <- t.n + 1
+
+let make ~name ~obj ~lb ~ub ~vtype ~sense ~rhs t =
+  {
+    name;
+    num_vars = Bigarray.Array1.dim obj;
+    obj;
+    lb;
+    ub;
+    vtype;
+    num_constrs = Bigarray.Array1.dim sense;
+    sense;
+    rhs;
+    num_nz = t.n;
+    row = t.t_row;
+    col = t.t_col;
+    value = t.t_value;
+  }
+
+let vars n ~ub ~vtype =
+  let lb = fa n and u = fa n and vt = ca n in
+  Bigarray.Array1.fill lb 0.0;
+  Bigarray.Array1.fill u ub;
+  Bigarray.Array1.fill vt vtype;
+  (lb, u, vt)
+
+(* [scenarios] demand scenarios of a facility location problem with [plants]
+   plants and [warehouses] warehouses, in extensive form: the plants to open
+   are shared, and each scenario has its own transportation variables. With a
+   single scenario, this is the model of test/facility.ml. *)
+let facility_scenarios ~rng ~plants ~warehouses ~scenarios =
+  let transport s w p = plants + (((s * warehouses) + w) * plants) + p in
+  let n = plants + (scenarios * warehouses * plants) in
+  let obj = fa n in
+  let lb, ub, vtype = vars n ~ub:GRB.infinity ~vtype:GRB.continuous in
+  for p = 0 to plants - 1 do
+    obj.{p} <- 10_000. +. Random.State.float rng 10_000.;
+    ub.{p} <- 1.0;
+    vtype.{p} <- GRB.binary
+  done;
+  let costs =
+    Array.init warehouses (fun _ ->
+        Array.init plants (fun _ -> 1000. +. Random.State.float rng 4000.))
+  in
+  for s = 0 to scenarios - 1 do
+    for w = 0 to warehouses - 1 do
+      for p = 0 to plants - 1 do
+        obj.{transport s w p} <- costs.(w).(p) /. float scenarios
+      done
+    done
+  done;
+  (* per scenario: capacity of each plant, then demand of each warehouse *)
+  let m = scenarios * (plants + warehouses) in
+  let sense = ca m and rhs = fa m in
+  let t = triples (scenarios * ((2 * warehouses * plants) + plants)) in
+  let capacity =
+    Array.init plants (fun _ -> 15. +. Random.State.float rng 10.)
+  in
+  for s = 0 to scenarios - 1 do
+    let first = s * (plants + warehouses) in
+    for p = 0 to plants - 1 do
+      let i = first + p in
+      for w = 0 to warehouses - 1 do
+        add t i (transport s w p) 1.0
+      done;
+      add t i p (-.capacity.(p));
+      sense.{i} <- GRB.less_equal;
+      rhs.{i} <- 0.0
+    done;
+    for w = 0 to warehouses - 1 do
+      let i = first + plants + w in
+      for p = 0 to plants - 1 do
+        add t i (transport s w p) 1.0
+      done;
+      sense.{i} <- GRB.equal;
+      rhs.{i} <-
+        (10. +. Random.State.float rng 10.) *. float plants
+        /. float (2 * warehouses)
+    done
+  done;
+  let name = if scenarios = 1 then "facility" else "multiscenario" in
+  make ~name ~obj ~lb ~ub ~vtype ~sense ~rhs t
+
+(* a model of about [size] variables, with four warehouses per plant *)
+let facility ~size =
+  let plants = max 1 (int_of_float (sqrt (float size /. 4.))) in
+  facility_scenarios
+    ~rng:(Random.State.make [| 1 |])
+    ~plants ~warehouses:(4 * plants) ~scenarios:1
+
+(* the same, with 8 scenarios sharing the plants *)
+let multiscenario ~size =
+  let scenarios = 8 in
+  let plants =
+    max 1 (int_of_float (sqrt (float size /. float (4 * scenarios))))
+  in
+  facility_scenarios
+    ~rng:(Random.State.make [| 2 |])
+    ~plants ~warehouses:(4 * plants) ~scenarios
+
+(* workers assigned to the shifts they are available for, each shift
+   needing a number of workers, with a penalized slack variable per shift:
+   about [size] variables, each worker being available for about half of the
+   shifts *)
+let workforce ~size =
+  let rng = Random.State.make [| 3 |] in
+  let shifts = max 2 (int_of_float (Float.pow (float size) (1. /. 3.))) in
+  let workers = max 1 (2 * size / shifts) in
+  let available w s = Hashtbl.hash (w, s) land 1 = 0 in
+  let num_x = ref 0 in
+  for w = 0 to workers - 1 do
+    for s = 0 to shifts - 1 do
+      if available w s then incr num_x
+    done
+  done;
+  let num_x = !num_x in
+  let n = num_x + shifts in
+  let lb, ub, vtype = vars n ~ub:1.0 ~vtype:GRB.binary in
+  let obj = fa n in
+  for s = 0 to shifts - 1 do
+    let j = num_x + s in
+    obj.{j} <- 1000.;
+    ub.{j} <- GRB.infinity;
+    vtype.{j} <- GRB.continuous
+  done;
+  let sense = ca shifts and rhs = fa shifts in
+  let t = triples n in
+  let j = ref 0 in
+  for w = 0 to workers - 1 do
+    for s = 0 to shifts - 1 do
+      if available w s then (
+        obj.{!j} <- 1.0 +. float (w mod 5);
+        add t s !j 1.0;
+        incr j)
+    done
+  done;
+  for s = 0 to shifts - 1 do
+    add t s (num_x + s) 1.0;
+    sense.{s} <- GRB.equal;
+    rhs.{s} <- float (1 + Random.State.int rng (max 1 (workers / 4)))
+  done;
+  make ~name:"workforce" ~obj ~lb ~ub ~vtype ~sense ~rhs t
+
+let of_name = function
+  | "facility" -> facility
+  | "workforce" -> workforce
+  | "multiscenario" -> multiscenario
+  | name -> invalid_arg ("Gen.of_name: " ^ name)
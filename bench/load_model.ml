@@ -0,0 +1,39 @@
+(* Compare building an LP with new_model, add_constrs and update_model
+   against building it with a single load_model.
+
+   usage: load_model.exe [rows] [columns] [nonzeros-per-column] [repetitions] *)
+
+open Guroobi
+open Raw
+open Common
+
+let () =
+  let m = int_arg 1 20_000 in
+  let n = int_arg 2 50_000 in
+  let k = int_arg 3 5 in
+  let repetitions = int_arg 4 5 in
+  let env = quiet_env () in
+  let { num_nz; csc; csr; objective; sense; rhs; _ } = random_lp ~m ~n ~k in
+
+  pr "%d rows, %d columns, %d nonzeros, %d repetitions\n" m n num_nz
+    repetitions;
+
+  measure "incremental" repetitions (fun () ->
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:None ~num_vars:n ~objective:(Some objective)
+             ~lower_bound:None ~upper_bound:None ~var_type:None ~var_name:None)
+      in
+      assert (
+        add_constrs ~model ~num:m ~matrix:(Some csr) ~sense ~rhs ~name:None = 0);
+      assert (update_model ~model = 0));
+
+  measure "load_model" repetitions (fun () ->
+      let model =
+        eer "load_model"
+          (load_model ~env ~name:None ~num_vars:n ~num_constrs:m
+             ~obj_sense:GRB.minimize ~obj_con:0.0 ~objective:(Some objective)
+             ~sense ~rhs ~matrix:csc ~lower_bound:None ~upper_bound:None
+             ~var_type:None ~var_name:None ~constr_name:None)
+      in
+      assert (update_model ~model = 0))
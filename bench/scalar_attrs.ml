@@ -0,0 +1,35 @@
+(* Compare the scalar attribute accessors of Raw with those of Raw.Fast, in a
+   bound-fixing loop over all variables.
+
+   usage: scalar_attrs.exe [model-file] [iterations] *)
+
+open Guroobi
+open Raw
+open Utils
+open Common
+
+let () =
+  let path, iterations = args ~default_iterations:1_000 in
+  let model = solved_model path in
+  let n = eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numvars) in
+  pr "%s: %d variables, %d iterations\n" path n iterations;
+
+  measure "get/set_float_attr_element" iterations (fun () ->
+      for index = 0 to n - 1 do
+        let x =
+          eer "get" (get_float_attr_element ~model ~name:GRB.dbl_attr_ub ~index)
+        in
+        assert (set_float_attr_element ~model ~name:GRB.dbl_attr_ub ~index ~value:x = 0)
+      done);
+
+  let err = i32a 1 in
+  measure "Fast.get/set_float_attr_element" iterations (fun () ->
+      for index = 0 to n - 1 do
+        let x =
+          Fast.get_float_attr_element ~model ~name:GRB.dbl_attr_ub ~index ~err
+        in
+        assert (err.{0} = 0l);
+        assert (
+          Fast.set_float_attr_element ~model ~name:GRB.dbl_attr_ub ~index ~value:x
+          = 0)
+      done)
@@ -0,0 +1,28 @@
+(* Create many models in a loop, and report the resident set size as it
+   goes, to check that the memory Gurobi uses for models does not grow
+   without bound. With "free", each model is freed explicitly with
+   free_model; otherwise, it is left to the GC.
+
+   usage: soak.exe [free|gc] [iterations] [rows] [columns] *)
+
+open Guroobi
+open Raw
+open Common
+
+let () =
+  let explicit = Array.length Sys.argv > 1 && Sys.argv.(1) = "free" in
+  let iterations = int_arg 2 2_000 in
+  let m = int_arg 3 5_000 in
+  let n = int_arg 4 10_000 in
+  let env = quiet_env () in
+  let lp = random_lp ~m ~n ~k:5 in
+  pr "%s, %d iterations of a %dx%d LP with %d nonzeros\n"
+    (if explicit then "free_model" else "gc")
+    iterations m n lp.num_nz;
+  for i = 1 to iterations do
+    let model = load_lp env lp in
+    assert (update_model ~model = 0);
+    if explicit then free_model model;
+    if i mod (max 1 (iterations / 20)) = 0 then
+      pr "%6d models: %6d MiB\n%!" i (rss_mib ())
+  done
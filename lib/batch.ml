@@ -0,0 +1,274 @@
+(** Batched modifications of a model.
+
+    A batch records attribute changes, coefficient changes and new
+    constraints, instead of passing each of them to Gurobi as it is made, and
+    passes them all at once, with one call per attribute
+    ({!Raw.set_float_attr_list} and the like), one {!Raw.chg_coeffs} and one
+    {!Raw.add_constrs}, when it is flushed. Changes of the same element are
+    coalesced, the last one winning, as it would with direct calls.
+
+    A batch is flushed by {!flush}, {!update_model} and {!optimize}. It must be
+    flushed before the model is used directly, e.g. to read attributes or to
+    change parameters that affect the meaning of attributes, such as
+    [ScenarioNumber]. Errors are reported when the batch is flushed. New
+    constraints are added before the other changes are made. *)
+
+open Bigarray
+open Raw
+
+(* a growable bigarray *)
+module Buf = struct
+  type ('a, 'b) t = {
+    kind : ('a, 'b) kind;
+    mutable data : ('a, 'b, c_layout) Array1.t;
+    mutable len : int;
+  }
+
+  let create kind = { kind; data = Array1.create kind c_layout 16; len = 0 }
+
+  let push b v =
+    let cap = Array1.dim b.data in
+    if b.len = cap then (
+      let data = Array1.create b.kind c_layout (2 * cap) in
+      Array1.blit b.data (Array1.sub data 0 cap);
+      b.data <- data);
+    b.data.{b.len} <- v;
+    b.len <- b.len + 1
+
+  let set b i v = b.data.{i} <- v
+  let contents b = Array1.sub b.data 0 b.len
+  let clear b = b.len <- 0
+end
+
+(* the pending changes of an attribute *)
+type ('a, 'b) attr_changes = {
+  ind : (int32, int32_elt) Buf.t;
+  values : ('a, 'b) Buf.t;
+  position : (int, int) Hashtbl.t;  (** of each index in [ind] *)
+}
+
+type t = {
+  model : model;
+  floats : (string, (float, float64_elt) attr_changes) Hashtbl.t;
+  ints : (string, (int32, int32_elt) attr_changes) Hashtbl.t;
+  chars : (string, (char, int8_unsigned_elt) attr_changes) Hashtbl.t;
+  (* coefficient changes *)
+  c_ind : (int32, int32_elt) Buf.t;
+  v_ind : (int32, int32_elt) Buf.t;
+  c_val : (float, float64_elt) Buf.t;
+  c_position : (int * int, int) Hashtbl.t;
+  (* new constraints, by rows *)
+  mutable num_constrs : int;
+  r_beg : (int32, int32_elt) Buf.t;
+  r_ind : (int32, int32_elt) Buf.t;
+  r_val : (float, float64_elt) Buf.t;
+  r_sense : (char, int8_unsigned_elt) Buf.t;
+  r_rhs : (float, float64_elt) Buf.t;
+  mutable r_names : string option list;  (** in reverse *)
+}
+
+(** [create model] is an empty batch of changes of [model] *)
+let create model =
+  {
+    model;
+    floats = Hashtbl.create 8;
+    ints = Hashtbl.create 8;
+    chars = Hashtbl.create 8;
+    c_ind = Buf.create int32;
+    v_ind = Buf.create int32;
+    c_val = Buf.create float64;
+    c_position = Hashtbl.create 64;
+    num_constrs = 0;
+    r_beg = Buf.create int32;
+    r_ind = Buf.create int32;
+    r_val = Buf.create float64;
+    r_sense = Buf.create char;
+    r_rhs = Buf.create float64;
+    r_names = [];
+  }
+
+(** [model b] is the model changed by [b] *)
+let model b = b.model
+
+let record table kind ~name ~index value =
+  let changes =
+    match Hashtbl.find_opt table name with
+    | Some changes -> changes
+    | None ->
+        let changes =
+          {
+            ind = Buf.create int32;
+            values = Buf.create kind;
+            position = Hashtbl.create 64;
+          }
+        in
+        Hashtbl.add table name changes;
+        changes
+  in
+  match Hashtbl.find_opt changes.position index with
+  | Some i -> Buf.set changes.values i value
+  | None ->
+      Hashtbl.add changes.position index changes.ind.len;
+      Buf.push changes.ind (Int32.of_int index);
+      Buf.push changes.values value
+
+(** [set_float_attr_element b ~name ~index ~value] records a
+    [Raw.set_float_attr_element] *)
+let set_float_attr_element b ~name ~index ~value =
+  record b.floats float64 ~name ~index value
+
+(** [set_int_attr_element b ~name ~index ~value] records a
+    [Raw.set_int_attr_element] *)
+let set_int_attr_element b ~name ~index ~value =
+  record b.ints int32 ~name ~index (Int32.of_int value)
+
+(** [set_char_attr_element b ~name ~index ~value] records a
+    [Raw.set_char_attr_element] *)
+let set_char_attr_element b ~name ~index ~value =
+  record b.chars char ~name ~index value
+
+(** [chg_coeff b ~constr ~var ~value] records the change of the coefficient
+    of variable [var] in constraint [constr] to [value] *)
+let chg_coeff b ~constr ~var ~value =
+  match Hashtbl.find_opt b.c_position (constr, var) with
+  | Some i -> Buf.set b.c_val i value
+  | None ->
+      Hashtbl.add b.c_position (constr, var) b.c_ind.len;
+      Buf.push b.c_ind (Int32.of_int constr);
+      Buf.push b.v_ind (Int32.of_int var);
+      Buf.push b.c_val value
+
+(** [chg_coeffs b ~num_chgs ~c_ind ~v_ind ~value] records a
+    [Raw.chg_coeffs] *)
+let chg_coeffs b ~num_chgs ~c_ind ~v_ind ~value =
+  for k = 0 to num_chgs - 1 do
+    chg_coeff b ~constr:(Int32.to_int c_ind.{k}) ~var:(Int32.to_int v_ind.{k})
+      ~value:value.{k}
+  done
+
+(** [add_constr b ~num_nz ~var_index ~nz ~sense ~rhs ~name] records a
+    [Raw.add_constr] *)
+let add_constr b ~num_nz ~var_index ~nz ~sense ~rhs ~name =
+  Buf.push b.r_beg (Int32.of_int b.r_ind.len);
+  for k = 0 to num_nz - 1 do
+    Buf.push b.r_ind var_index.{k};
+    Buf.push b.r_val nz.{k}
+  done;
+  Buf.push b.r_sense sense;
+  Buf.push b.r_rhs rhs;
+  b.r_names <- name :: b.r_names;
+  b.num_constrs <- b.num_constrs + 1
+
+(* add constraints [first] to [first + num - 1], all named or all unnamed *)
+let add_constr_range b ~first ~num names =
+  let sub buf first num = Array1.sub (Buf.contents buf) first num in
+  let nz_first = Int32.to_int b.r_beg.data.{first} in
+  let nz_end =
+    if first + num = b.num_constrs then b.r_ind.len
+    else Int32.to_int b.r_beg.data.{first + num}
+  in
+  let num_nz = nz_end - nz_first in
+  let xbeg = Array1.create int32 c_layout num in
+  for i = 0 to num - 1 do
+    xbeg.{i} <- Int32.sub b.r_beg.data.{first + i} (Int32.of_int nz_first)
+  done;
+  let matrix =
+    {
+      num_nz;
+      xbeg;
+      xind = sub b.r_ind nz_first num_nz;
+      xval = sub b.r_val nz_first num_nz;
+    }
+  in
+  let name =
+    match names with
+    | Some _ :: _ -> Some (Array.of_list (List.map Option.get names))
+    | _ -> None
+  in
+  add_constrs ~model:b.model ~num ~matrix:(Some matrix)
+    ~sense:(sub b.r_sense first num) ~rhs:(sub b.r_rhs first num) ~name
+
+(* GRBaddconstrs takes names for all of the constraints or none of them, so
+   constraints are added in runs of named and unnamed ones *)
+let flush_constrs b =
+  let rec runs first = function
+    | [] -> 0
+    | name :: _ as names ->
+        let named = Option.is_some name in
+        let rec split acc n = function
+          | x :: rest when Option.is_some x = named ->
+              split (x :: acc) (n + 1) rest
+          | rest -> (List.rev acc, n, rest)
+        in
+        let run, num, rest = split [] 0 names in
+        let error = add_constr_range b ~first ~num run in
+        if error <> 0 then error else runs (first + num) rest
+  in
+  let error = runs 0 (List.rev b.r_names) in
+  b.num_constrs <- 0;
+  Buf.clear b.r_beg;
+  Buf.clear b.r_ind;
+  Buf.clear b.r_val;
+  Buf.clear b.r_sense;
+  Buf.clear b.r_rhs;
+  b.r_names <- [];
+  error
+
+let flush_coeffs b =
+  let num_chgs = b.c_ind.len in
+  let error =
+    if num_chgs = 0 then 0
+    else
+      Raw.chg_coeffs ~model:b.model ~num_chgs ~c_ind:(Buf.contents b.c_ind)
+        ~v_ind:(Buf.contents b.v_ind) ~value:(Buf.contents b.c_val)
+  in
+  Buf.clear b.c_ind;
+  Buf.clear b.v_ind;
+  Buf.clear b.c_val;
+  Hashtbl.reset b.c_position;
+  error
+
+let flush_attrs table set b =
+  let error =
+    Hashtbl.fold
+      (fun name changes error ->
+        let e =
+          set ~model:b.model ~name ~num:changes.ind.len
+            ~ind:(Buf.contents changes.ind)
+            ~values:(Buf.contents changes.values)
+        in
+        if error <> 0 then error else e)
+      table 0
+  in
+  Hashtbl.reset table;
+  error
+
+(** [flush b] makes the changes recorded in [b], and empties it. The result
+    is the error code of the first call to fail, if any. The other calls are
+    made nonetheless, except for the constraints following those that could
+    not be added. *)
+let flush b =
+  let steps =
+    [
+      flush_constrs;
+      flush_coeffs;
+      flush_attrs b.floats set_float_attr_list;
+      flush_attrs b.ints set_int_attr_list;
+      flush_attrs b.chars set_char_attr_list;
+    ]
+  in
+  List.fold_left
+    (fun error step ->
+      let e = step b in
+      if error <> 0 then error else e)
+    0 steps
+
+(** [update_model b] flushes [b], then updates its model *)
+let update_model b =
+  let error = flush b in
+  if error <> 0 then error else Raw.update_model ~model:b.model
+
+(** [optimize b] flushes [b], then optimizes its model *)
+let optimize b =
+  let error = flush b in
+  if error <> 0 then error else Raw.optimize b.model
@@ -0,0 +1,164 @@
+(** A pool of started environments, to avoid paying for [start_env] (license
+    check, thread setup) on every use, and to bound the number of
+    environments in use at once, e.g. to what a license allows.
+
+    Environments are handed out with their parameters at a baseline: Gurobi's
+    defaults, followed by the [baseline] function given to {!create}. They are
+    reset to it when they are given back. Parameters that only take effect
+    when an environment is started, such as license or Compute Server
+    settings, are not restored: [baseline] sets them once, before
+    [start_env], and changing them afterwards has no effect.
+
+    Environments that the pool drops (see {!release} and {!close}) are freed
+    right away, which releases their license seat, unless models created in
+    them have not been freed with {!Raw.free_model}: such an environment is
+    left to the GC, and holds its seat until it is collected, possibly past
+    the size of the pool. *)
+
+type t = {
+  size : int;
+  baseline : Raw.env -> unit;
+  mutex : Mutex.t;
+  available : Condition.t;
+  mutable idle : Raw.env list;
+  mutable created : int;  (** environments alive, idle or in use *)
+  mutable closed : bool;
+}
+
+(* free [env] now, unless models created in it are still alive *)
+let free env = try Raw.free_env env with Invalid_argument _ -> ()
+
+(* a new started environment, at the baseline *)
+let start baseline =
+  match Raw.empty_env () with
+  | Error code -> raise (Raw.Gurobi_error code)
+  | Ok env -> (
+      match
+        baseline env;
+        Raw.start_env env
+      with
+      | 0 -> env
+      | code ->
+          free env;
+          raise (Raw.Gurobi_error code)
+      | exception e ->
+          free env;
+          raise e)
+
+let locked t f =
+  Mutex.lock t.mutex;
+  Fun.protect ~finally:(fun () -> Mutex.unlock t.mutex) f
+
+(** [create ?baseline ~size ()] is a pool of at most [size] environments, all
+    of which are started right away. [baseline] (by default, nothing) is
+    applied to each environment before it is started, and whenever it is given
+    back; it should only set parameters. Raises [Raw.Gurobi_error] if an
+    environment cannot be started. *)
+let create ?(baseline = fun _ -> ()) ~size () =
+  if size < 1 then invalid_arg "Env_pool.create: size";
+  let idle = List.init size (fun _ -> start baseline) in
+  {
+    size;
+    baseline;
+    mutex = Mutex.create ();
+    available = Condition.create ();
+    idle;
+    created = size;
+    closed = false;
+  }
+
+(** [acquire t] is an environment of the pool, waiting until one is given
+    back if they are all in use *)
+let acquire t =
+  let take () =
+    locked t (fun () ->
+        let rec wait () =
+          if t.closed then invalid_arg "Env_pool.acquire: closed pool"
+          else
+            match t.idle with
+            | env :: rest ->
+                t.idle <- rest;
+                Some env
+            | [] when t.created < t.size ->
+                (* one was discarded, see [release]; replace it *)
+                t.created <- t.created + 1;
+                None
+            | [] ->
+                Condition.wait t.available t.mutex;
+                wait ()
+        in
+        wait ())
+  in
+  match take () with
+  | Some env -> env
+  | None -> (
+      try start t.baseline
+      with e ->
+        locked t (fun () ->
+            t.created <- t.created - 1;
+            Condition.signal t.available);
+        raise e)
+
+(** [try_acquire t] is an environment of the pool, if one is idle *)
+let try_acquire t =
+  locked t (fun () ->
+      match t.idle with
+      | env :: rest when not t.closed ->
+          t.idle <- rest;
+          Some env
+      | _ -> None)
+
+(** [release t env] gives [env], obtained from [acquire t], back to the pool,
+    after resetting its parameters. If they cannot be reset ([baseline]
+    raising [Raw.Gurobi_error]), or if [t] was closed, [env] is dropped
+    instead, and a new environment will be started when needed. Other
+    exceptions of [baseline] also drop [env], and are raised again. *)
+let release t env =
+  let give_back reset =
+    let kept =
+      reset
+      && locked t (fun () ->
+             if t.closed then false
+             else (
+               t.idle <- env :: t.idle;
+               Condition.signal t.available;
+               true))
+    in
+    if not kept then (
+      (* freed first, so that its replacement does not exceed [size] *)
+      free env;
+      locked t (fun () ->
+          t.created <- t.created - 1;
+          Condition.signal t.available))
+  in
+  match
+    Raw.reset_params env = 0
+    && (try
+          t.baseline env;
+          true
+        with Raw.Gurobi_error _ -> false)
+  with
+  | reset -> give_back reset
+  | exception e ->
+      give_back false;
+      raise e
+
+(** [with_env t f] is [f env], for an environment [env] acquired from [t] for
+    the duration of the call *)
+let with_env t f =
+  let env = acquire t in
+  Fun.protect ~finally:(fun () -> release t env) (fun () -> f env)
+
+(** [close t] frees the idle environments of [t]; the others are freed once
+    given back. [acquire t] fails afterwards. *)
+let close t =
+  let idle =
+    locked t (fun () ->
+        let idle = t.idle in
+        t.idle <- [];
+        t.closed <- true;
+        t.created <- t.created - List.length idle;
+        Condition.broadcast t.available;
+        idle)
+  in
+  List.iter free idle
@@ -10,6 +10,7 @@
 #include <caml/intext.h>
 #include <caml/fail.h>
 #include <caml/threads.h>
+#include <caml/signals.h>
 #include <caml/bigarray.h>
 
 /* Gurobi */
@@ -20,8 +21,15 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
 
 // naming convention: Gurobi's functions consist of multiple words,
 // concatenated without a space, resulting in unfortunate
@@ -29,19 +37,203 @@
 // underscores. For example, we would wrap a Gurobi function
 // GRBpickupthemilk with function gu_pick_up_the_milk.
 
-#define env_val(v) (*((GRBenv **) Data_custom_val(v)))
-#define model_val(v) (*((GRBmodel **) Data_custom_val(v)))
+// an OCaml closure registered as a Gurobi callback on a model; the
+// values are generational global roots
+struct gu_callback {
+  value closure;     // cb_context -> where:int -> unit
+  value v_ctx;       // cb_context, passed to every invocation of closure
+  value exn;         // first exception raised by closure during the
+                     // current optimization, Val_unit if none
+  unsigned int wheres; // bitmask of the where codes passed on to closure
+};
+
+// the data of an env custom block
+struct gu_env {
+  GRBenv* env;       // NULL once freed
+  value* log_buffer; // see set_root
+  long num_models;   // models created in env, and not yet freed
+  int busy;          // calls using env without the runtime lock, see hold
+};
+
+// the data of a model custom block
+struct gu_model {
+  GRBmodel* model; // NULL once freed
+  struct gu_callback* callback; // NULL if no callback is registered
+  value* log_buffer; // see set_root
+  value* env; // the env the model was created in, kept alive by the model
+  size_t mem; // estimate of the memory used by Gurobi, reported to the GC
+  int busy; // calls using model without the runtime lock, see hold
+};
+
+// a bounded ring buffer of log messages, filled by Gurobi's log
+// callback and drained from OCaml. Each message is stored as a
+// 4-byte length followed by its bytes, possibly wrapping around the
+// end of data. The producer side never blocks on the OCaml runtime;
+// when the buffer is full, messages are dropped and counted.
+struct gu_logring {
+  char* data;
+  size_t mask;             // capacity - 1, capacity being a power of 2
+  atomic_size_t head;      // total bytes written, owned by producers
+  atomic_size_t tail;      // total bytes read, owned by the consumer
+  atomic_size_t dropped;   // number of messages dropped
+  atomic_flag producing;   // serializes producers, if there are several
+};
+
+// the data of a cb_context custom block. It is allocated once, when
+// the callback is registered, and updated in place on every
+// invocation, so that calling into OCaml does not allocate.
+struct gu_cbctx {
+  GRBmodel* model;
+  void* cbdata;  // NULL outside of callback invocations
+  int where;
+  int num_vars;  // number of variables at the start of optimization
+  double* scratch; // max(num_vars, 1) elements, owned by the callback:
+                   // GRBcbget writes a whole vector for some what codes
+};
+
+#define env_block(v) ((struct gu_env *) Data_custom_val(v))
+#define env_val(v) (checked_env(v))
+#define logring_val(v) (*((struct gu_logring **) Data_custom_val(v)))
+#define model_block(v) ((struct gu_model *) Data_custom_val(v))
+#define model_val(v) (checked_model(v))
+#define cbctx_val(v) ((struct gu_cbctx *) Data_custom_val(v))
+
+static void gu_callback_free( struct gu_callback* callback )
+{
+  struct gu_cbctx* ctx = cbctx_val( callback->v_ctx );
+  free( ctx->scratch );
+  ctx->scratch = NULL;
+  caml_remove_generational_global_root( &callback->closure );
+  caml_remove_generational_global_root( &callback->v_ctx );
+  caml_remove_generational_global_root( &callback->exn );
+  free( callback );
+}
+
+// custom blocks may be moved by the GC, so the values an env or
+// model refers to (its log buffer, the env of a model) are held by
+// generational global roots in separately allocated cells. *root is
+// NULL when there is no such value. Replace its contents by v, which
+// is Val_unit for none.
+static void set_root( value** root, value v )
+{
+  if ( *root == NULL && v != Val_unit ) {
+    *root = malloc( sizeof(value) );
+    if ( *root == NULL ) {
+      caml_raise_out_of_memory();
+    }
+    **root = v;
+    caml_register_generational_global_root( *root );
+  }
+  else if ( *root != NULL && v == Val_unit ) {
+    caml_remove_generational_global_root( *root );
+    free( *root );
+    *root = NULL;
+  }
+  else if ( *root != NULL ) {
+    caml_modify_generational_global_root( *root, v );
+  }
+}
+
+static value root_value( value* root )
+{
+  return root == NULL ? Val_unit : *root;
+}
+
+static GRBenv* checked_env( value v_env )
+{
+  GRBenv* env = env_block( v_env )->env;
+  if ( env == NULL ) {
+    caml_invalid_argument( "env has been freed" );
+  }
+  return env;
+}
+
+static GRBmodel* checked_model( value v_model )
+{
+  GRBmodel* model = model_block( v_model )->model;
+  if ( model == NULL ) {
+    caml_invalid_argument( "model has been freed" );
+  }
+  return model;
+}
+
+// an estimate of the memory Gurobi uses for a model, in bytes, from
+// its size: a fixed overhead, attributes and names of variables and
+// constraints, and the matrix, which Gurobi holds both by rows and by
+// columns
+static size_t model_mem_estimate( GRBmodel* model )
+{
+  int num_vars = 0, num_constrs = 0, num_qnz = 0;
+  double num_nz = 0.0;
+  GRBgetintattr( model, "NumVars", &num_vars );
+  GRBgetintattr( model, "NumConstrs", &num_constrs );
+  GRBgetintattr( model, "NumQNZs", &num_qnz );
+  GRBgetdblattr( model, "DNumNZs", &num_nz );
+  return 65536
+    + 128 * (size_t)num_vars
+    + 128 * (size_t)num_constrs
+    + 24 * (size_t)num_nz
+    + 24 * (size_t)num_qnz;
+}
+
+// growth of a model, past what was reported to the GC, speeds up the
+// major GC, so that a full cycle is completed for every
+// GU_MODEL_MEM_MAX bytes of growth
+#define GU_MODEL_MEM_MAX ((size_t)1 << 30)
+
+static void refresh_model_mem( struct gu_model* block )
+{
+  size_t mem = model_mem_estimate( block->model );
+  if ( mem > block->mem ) {
+    caml_adjust_gc_speed( mem - block->mem, GU_MODEL_MEM_MAX );
+    block->mem = mem;
+  }
+}
+
+// calls to Gurobi that release the runtime lock, and asynchronous
+// solves, hold their model or env for their duration, so that
+// free_model and free_env refuse to free it under them. The counts
+// are only changed with the runtime lock held.
+#define hold(block) ((block)->busy++)
+#define unhold(block) ((block)->busy--)
+
+// free the Gurobi model now, rather than when the block is finalized
+static void dispose_model( struct gu_model* block )
+{
+  if ( block->model != NULL ) {
+    GRBfreemodel( block->model );
+    block->model = NULL;
+  }
+  if ( block->callback != NULL ) {
+    gu_callback_free( block->callback );
+    block->callback = NULL;
+  }
+  set_root( &block->log_buffer, Val_unit );
+  if ( block->env != NULL ) {
+    env_block( *block->env )->num_models--;
+    set_root( &block->env, Val_unit );
+  }
+}
 
 void gu_env_finalize(value v_env)
 {
-  GRBenv* env = env_val( v_env );
-  GRBfreeenv( env );
+  struct gu_env* block = env_block( v_env );
+  if ( block->env != NULL ) {
+    GRBfreeenv( block->env );
+  }
+  set_root( &block->log_buffer, Val_unit );
 }
 
 void gu_model_finalize(value v_model)
 {
-  GRBmodel* model = model_val( v_model );
-  GRBfreemodel( model );
+  dispose_model( model_block( v_model ) );
+}
+
+void gu_logring_finalize(value v_buf)
+{
+  struct gu_logring* ring = logring_val( v_buf );
+  free( ring->data );
+  free( ring );
 }
 
 static struct custom_operations env_ops = {
@@ -55,17 +247,244 @@ static struct custom_operations env_ops = {
   custom_fixed_length_default
 };
 
+static void gu_model_serialize( value v_model, uintnat* bsize_32, uintnat* bsize_64 );
+static uintnat gu_model_deserialize( void* dst );
+
 static struct custom_operations model_ops = {
   "gurobi.model",
   gu_model_finalize,
   custom_compare_default,
   custom_hash_default,
+  gu_model_serialize,
+  gu_model_deserialize,
+  custom_compare_ext_default,
+  custom_fixed_length_default
+};
+
+static struct custom_operations cbctx_ops = {
+  "gurobi.cbctx",
+  custom_finalize_default,
+  custom_compare_default,
+  custom_hash_default,
+  custom_serialize_default,
+  custom_deserialize_default,
+  custom_compare_ext_default,
+  custom_fixed_length_default
+};
+
+static struct custom_operations logring_ops = {
+  "gurobi.logring",
+  gu_logring_finalize,
+  custom_compare_default,
+  custom_hash_default,
   custom_serialize_default,
   custom_deserialize_default,
   custom_compare_ext_default,
   custom_fixed_length_default
 };
 
+// the custom block for a model created in env v_env; the model
+// inherits the log buffer of log_buffer_root
+static value alloc_model( GRBmodel* model, value v_env, value* log_buffer_root )
+{
+  CAMLparam1( v_env );
+  CAMLlocal1( v_model );
+  size_t mem = model_mem_estimate( model );
+  v_model = caml_alloc_custom_mem( &model_ops, sizeof(struct gu_model), mem );
+  struct gu_model* block = model_block( v_model );
+  block->model = model;
+  block->callback = NULL;
+  block->log_buffer = NULL;
+  block->env = NULL;
+  block->mem = mem;
+  block->busy = 0;
+  set_root( &block->log_buffer, root_value( log_buffer_root ) );
+  set_root( &block->env, v_env );
+  env_block( v_env )->num_models++;
+  CAMLreturn( v_model );
+}
+
+// raise exception Raw.Gurobi_error
+static void raise_error( int error )
+{
+  const value* exn = caml_named_value( "guroobi.error" );
+  assert( exn != NULL );
+  caml_raise_with_arg( *exn, Val_int( error ) );
+}
+
+// opt-in instrumentation: when enabled, with instrument_enable or the
+// GUROOBI_INSTRUMENT environment variable, GU_TIMED counts the calls to
+// Gurobi made by each stub, for each attribute or parameter name, along
+// with their errors and a log2 histogram of their latencies. When
+// disabled, GU_TIMED(name, call) costs a single, predictable branch.
+
+#define GU_HIST_BUCKETS 40   // latencies of 2^i ns, up to 2^39 ns (9 minutes)
+#define GU_STATS_SIZE 1024   // (stub, name) pairs, a power of 2
+#define GU_STAT_NAME_MAX 64
+
+struct gu_stat {
+  const char* stub;  // NULL if unused; a C function name, so never freed
+  char name[GU_STAT_NAME_MAX]; // attribute or parameter, "" if none
+  uint64_t calls;
+  uint64_t errors;
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint64_t hist[GU_HIST_BUCKETS];
+};
+
+static atomic_int gu_instrument_on;
+static struct gu_stat gu_stats[GU_STATS_SIZE];
+static uint64_t gu_stats_dropped; // calls not recorded, the table being full
+static pthread_mutex_t gu_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t gu_now_ns( void )
+{
+  struct timespec t;
+  clock_gettime( CLOCK_MONOTONIC, &t );
+  return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static void gu_record( const char* stub, const char* name, uint64_t t0, int error )
+{
+  uint64_t ns = gu_now_ns() - t0;
+  if ( name == NULL ) {
+    name = "";
+  }
+  uint64_t h = (uintptr_t)stub;
+  for (const char* c = name; *c != '\0'; c++) {
+    h = (h ^ (unsigned char)*c) * 1099511628211u;
+  }
+  int bucket = ns == 0 ? 0 : 63 - __builtin_clzll( ns );
+  if ( bucket >= GU_HIST_BUCKETS ) {
+    bucket = GU_HIST_BUCKETS - 1;
+  }
+
+  pthread_mutex_lock( &gu_stats_lock );
+  struct gu_stat* stat = NULL;
+  for (size_t i = 0; i < GU_STATS_SIZE; i++) {
+    struct gu_stat* s = &gu_stats[(h + i) & (GU_STATS_SIZE - 1)];
+    if ( s->stub == NULL ) {
+      s->stub = stub;
+      strncpy( s->name, name, GU_STAT_NAME_MAX - 1 );
+      stat = s;
+      break;
+    }
+    if ( s->stub == stub && strncmp( s->name, name, GU_STAT_NAME_MAX - 1 ) == 0 ) {
+      stat = s;
+      break;
+    }
+  }
+  if ( stat == NULL ) {
+    gu_stats_dropped++;
+  }
+  else {
+    stat->calls++;
+    stat->errors += error != 0;
+    stat->total_ns += ns;
+    if ( ns > stat->max_ns ) {
+      stat->max_ns = ns;
+    }
+    stat->hist[bucket]++;
+  }
+  pthread_mutex_unlock( &gu_stats_lock );
+}
+
+// the error code of call, a call to Gurobi, timed if instrumentation is
+// enabled; name is evaluated after the call
+#define GU_TIMED(name, call)                                            \
+  ( __builtin_expect( atomic_load_explicit( &gu_instrument_on,          \
+                                            memory_order_relaxed ), 0 ) \
+    ? ({ uint64_t gu_t0_ = gu_now_ns();                                 \
+         int gu_error_ = (call);                                        \
+         gu_record( __func__, (name), gu_t0_, gu_error_ );              \
+         gu_error_; })                                                  \
+    : (call) )
+
+__attribute__((constructor))
+static void gu_instrument_init( void )
+{
+  const char* v = getenv( "GUROOBI_INSTRUMENT" );
+  if ( v != NULL && *v != '\0' && strcmp( v, "0" ) != 0 ) {
+    atomic_store( &gu_instrument_on, 1 );
+  }
+}
+
+CAMLprim value gu_instrument_enable( value v_on )
+{
+  CAMLparam1( v_on );
+  atomic_store( &gu_instrument_on, Bool_val( v_on ) );
+  CAMLreturn( Val_unit );
+}
+
+CAMLprim value gu_instrument_enabled( value v_unit )
+{
+  CAMLparam1( v_unit );
+  CAMLreturn( Val_bool( atomic_load( &gu_instrument_on ) ) );
+}
+
+CAMLprim value gu_instrument_reset( value v_unit )
+{
+  CAMLparam1( v_unit );
+  pthread_mutex_lock( &gu_stats_lock );
+  memset( gu_stats, 0, sizeof(gu_stats) );
+  gu_stats_dropped = 0;
+  pthread_mutex_unlock( &gu_stats_lock );
+  CAMLreturn( Val_unit );
+}
+
+// an array of (stub, name, calls, errors, total_ns, max_ns, histogram)
+// tuples, and the number of calls not recorded
+CAMLprim value gu_instrument_snapshot( value v_unit )
+{
+  CAMLparam1( v_unit );
+  CAMLlocal5( v_stats, v_stat, v_hist, v_s, v_res );
+
+  // copied first, as allocating while holding the lock could deadlock
+  // with a thread waiting for it in a blocking section
+  struct gu_stat* copy = malloc( sizeof(gu_stats) );
+  if ( copy == NULL ) {
+    caml_raise_out_of_memory();
+  }
+  pthread_mutex_lock( &gu_stats_lock );
+  memcpy( copy, gu_stats, sizeof(gu_stats) );
+  uint64_t dropped = gu_stats_dropped;
+  pthread_mutex_unlock( &gu_stats_lock );
+
+  int n = 0;
+  for (int i = 0; i < GU_STATS_SIZE; i++) {
+    n += copy[i].stub != NULL;
+  }
+  v_stats = caml_alloc_tuple( n );
+  int k = 0;
+  for (int i = 0; i < GU_STATS_SIZE; i++) {
+    struct gu_stat* s = &copy[i];
+    if ( s->stub == NULL ) {
+      continue;
+    }
+    v_hist = caml_alloc_tuple( GU_HIST_BUCKETS );
+    for (int b = 0; b < GU_HIST_BUCKETS; b++) {
+      Store_field( v_hist, b, Val_long( s->hist[b] ) );
+    }
+    v_stat = caml_alloc_tuple( 7 );
+    v_s = caml_copy_string( s->stub );
+    Store_field( v_stat, 0, v_s );
+    v_s = caml_copy_string( s->name );
+    Store_field( v_stat, 1, v_s );
+    Store_field( v_stat, 2, Val_long( s->calls ) );
+    Store_field( v_stat, 3, Val_long( s->errors ) );
+    Store_field( v_stat, 4, Val_long( s->total_ns ) );
+    Store_field( v_stat, 5, Val_long( s->max_ns ) );
+    Store_field( v_stat, 6, v_hist );
+    Store_field( v_stats, k++, v_stat );
+  }
+  free( copy );
+
+  v_res = caml_alloc_tuple( 2 );
+  Store_field( v_res, 0, v_stats );
+  Store_field( v_res, 1, Val_long( dropped ) );
+  CAMLreturn( v_res );
+}
+
 /* corresponding to OCaml Bigarray type (float, float64_elt, c_layout) Array1.t */
 static double* get_fa( value a, int min_n ) {
   if ( (Caml_ba_array_val(a)->num_dims == 1) &&
@@ -105,6 +524,21 @@ static char* get_ca( value a, int min_n ) {
   }
 }
 
+// the address of element [offset] of a 1-dimensional bigarray of the given
+// kind, if it holds at least [offset + n] elements; NULL otherwise
+static void* get_ba_range( value a, int kind, long offset, long n ) {
+  struct caml_ba_array* ba = Caml_ba_array_val(a);
+  if ( ba->num_dims == 1 &&
+       (ba->flags & CAML_BA_KIND_MASK) == kind &&
+       offset >= 0 && n >= 0 &&
+       ba->dim[0] - offset >= n ) {
+    return (char*)ba->data + offset * caml_ba_element_size[kind];
+  }
+  else {
+    return NULL;
+  }
+}
+
 // from a value representing an OCaml array of strings, return a
 // heap-allocated C array of null-terminated C-strings.
 static const char** get_sa( value v_sa, int expected_n )
@@ -124,16 +558,54 @@ static const char** get_sa( value v_sa, int expected_n )
   }
 }
 
+// names given either as an OCaml string array, or packed as a
+// NUL-separated char bigarray and an int32 bigarray of offsets into
+// it. The result points into the OCaml values, and must be freed
+// (but not its elements) by the caller.
+static const char** get_names( value v_names, int n, int packed )
+{
+  if ( ! packed ) {
+    return get_sa( v_names, n );
+  }
+  value v_data = Field( v_names, 0 );
+  value v_offsets = Field( v_names, 1 );
+  struct caml_ba_array* data = Caml_ba_array_val( v_data );
+  int* offsets = get_i32a( v_offsets, n );
+  if ( offsets == NULL ||
+       data->num_dims != 1 ||
+       (data->flags & CAML_BA_KIND_MASK) != CAML_BA_CHAR ||
+       data->dim[0] == 0 ||
+       ((char*)data->data)[data->dim[0] - 1] != '\0' ) {
+    // the last byte must be NUL, so that every name is terminated
+    return NULL;
+  }
+  const char** names = malloc( sizeof(char*) * (n > 0 ? n : 1) );
+  if ( names == NULL ) {
+    return NULL;
+  }
+  for ( int i = 0; i < n; i++ ) {
+    if ( offsets[i] < 0 || offsets[i] >= data->dim[0] ) {
+      free( names );
+      return NULL;
+    }
+    names[i] = (char*)data->data + offsets[i];
+  }
+  return names;
+}
+
 CAMLprim value gu_empty_env( value unit )
 {
   CAMLparam1( unit /* unused */ );
   CAMLlocal2( v_res, v_env );
 
   GRBenv* env = NULL;
-  int error = GRBemptyenv(&env);
+  int error = GU_TIMED( NULL, GRBemptyenv(&env) );
   if ( error == 0 ) {
-    v_env = caml_alloc_custom(&env_ops, sizeof(GRBenv*), 0, 1);
-    env_val(v_env) = env;
+    v_env = caml_alloc_custom(&env_ops, sizeof(struct gu_env), 0, 1);
+    env_block(v_env)->env = env;
+    env_block(v_env)->log_buffer = NULL;
+    env_block(v_env)->num_models = 0;
+    env_block(v_env)->busy = 0;
 
     // Ok t
     v_res = caml_alloc(1, 0);
@@ -152,7 +624,21 @@ CAMLprim value gu_start_env( value v_env )
 {
   CAMLparam1( v_env );
   GRBenv* env = env_val(v_env);
-  int error = GRBstartenv( env );
+  // may take a while, e.g. to reach a license server
+  hold( env_block(v_env) );
+  caml_enter_blocking_section();
+  int error = GU_TIMED( NULL, GRBstartenv( env ) );
+  caml_leave_blocking_section();
+  unhold( env_block(v_env) );
+  CAMLreturn( Val_int( error ) );
+}
+
+// reset all parameters of an environment to their default values
+CAMLprim value gu_reset_params( value v_env )
+{
+  CAMLparam1( v_env );
+  GRBenv* env = env_val(v_env);
+  int error = GU_TIMED( NULL, GRBresetparams( env ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -163,7 +649,7 @@ CAMLprim value gu_set_int_param( value v_env, value v_name, value v_i )
   GRBenv* env = env_val(v_env);
   const char* name = String_val(v_name);
   int i = Int_val(v_i);
-  int error = GRBsetintparam( env, name, i );
+  int error = GU_TIMED( name, GRBsetintparam( env, name, i ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -175,7 +661,7 @@ CAMLprim value gu_set_int_model_param( value v_model, value v_name, value v_i )
   int i = Int_val(v_i);
   GRBenv* env = GRBgetenv( model );
   assert( env != NULL );
-  int error = GRBsetintparam( env, name, i );
+  int error = GU_TIMED( name, GRBsetintparam( env, name, i ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -186,7 +672,7 @@ CAMLprim value gu_get_int_param( value v_env, value v_name )
   GRBenv* env = env_val(v_env);
   const char* name = String_val(v_name);
   int i;
-  int error = GRBgetintparam( env, name, &i );
+  int error = GU_TIMED( name, GRBgetintparam( env, name, &i ) );
   if ( error == 0 ) {
     // Ok i
     v_res = caml_alloc(1, 0);
@@ -209,7 +695,7 @@ CAMLprim value gu_get_int_model_param( value v_model, value v_name )
   int i;
   GRBenv* env = GRBgetenv( model );
   assert ( env != NULL );
-  int error = GRBgetintparam( env, name, &i );
+  int error = GU_TIMED( name, GRBgetintparam( env, name, &i ) );
   if ( error == 0 ) {
     // Ok i
     v_res = caml_alloc(1, 0);
@@ -230,7 +716,7 @@ CAMLprim value gu_set_str_param( value v_env, value v_name, value v_i )
   GRBenv* env = env_val(v_env);
   const char* name = String_val(v_name);
   const char* s = String_val(v_i);
-  int error = GRBsetstrparam( env, name, s );
+  int error = GU_TIMED( name, GRBsetstrparam( env, name, s ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -242,7 +728,7 @@ CAMLprim value gu_set_str_model_param( value v_model, value v_name, value v_i )
   const char* s = String_val(v_i);
   GRBenv* env = GRBgetenv( model );
   assert ( env != NULL );
-  int error = GRBsetstrparam( env, name, s );
+  int error = GU_TIMED( name, GRBsetstrparam( env, name, s ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -253,7 +739,7 @@ CAMLprim value gu_get_str_param( value v_env, value v_name )
   GRBenv* env = env_val(v_env);
   const char* name = String_val(v_name);
   char s[GRB_MAX_STRLEN];
-  int error = GRBgetstrparam( env, name, s );
+  int error = GU_TIMED( name, GRBgetstrparam( env, name, s ) );
   if ( error == 0 ) {
     v_s = caml_copy_string( s );
 
@@ -278,7 +764,7 @@ CAMLprim value gu_get_str_model_param( value v_model, value v_name )
   char s[GRB_MAX_STRLEN];
   GRBenv* env = GRBgetenv( model );
   assert ( env != NULL );
-  int error = GRBgetstrparam( env, name, s );
+  int error = GU_TIMED( name, GRBgetstrparam( env, name, s ) );
   if ( error == 0 ) {
     v_s = caml_copy_string( s );
 
@@ -301,7 +787,7 @@ CAMLprim value gu_set_float_param( value v_env, value v_name, value v_f )
   GRBenv* env = env_val(v_env);
   const char* name = String_val(v_name);
   double f = Double_val(v_f);
-  int error = GRBsetdblparam( env, name, f );
+  int error = GU_TIMED( name, GRBsetdblparam( env, name, f ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -313,7 +799,7 @@ CAMLprim value gu_set_float_model_param( value v_model, value v_name, value v_f
   double f = Double_val(v_f);
   GRBenv* env = GRBgetenv( model );
   assert( env != NULL );
-  int error = GRBsetdblparam( env, name, f );
+  int error = GU_TIMED( name, GRBsetdblparam( env, name, f ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -324,7 +810,7 @@ CAMLprim value gu_get_float_param( value v_env, value v_name )
   GRBenv* env = env_val(v_env);
   const char* name = String_val(v_name);
   double f;
-  int error = GRBgetdblparam( env, name, &f );
+  int error = GU_TIMED( name, GRBgetdblparam( env, name, &f ) );
   if ( error == 0 ) {
     v_f = caml_copy_double(f);
     // Ok f
@@ -348,7 +834,7 @@ CAMLprim value gu_get_float_model_param( value v_model, value v_name )
   double f;
   GRBenv* env = GRBgetenv( model );
   assert( env != NULL );
-  int error = GRBgetdblparam( env, name, &f );
+  int error = GU_TIMED( name, GRBgetdblparam( env, name, &f ) );
   if ( error == 0 ) {
     v_f = caml_copy_double(f);
     // Ok f
@@ -378,7 +864,7 @@ CAMLprim value gu_set_float_attr_array(
   int start = Int_val(v_start);
   int len = Int_val(v_len);
   double* values = get_fa(v_values, len);
-  int error = GRBsetdblattrarray( model, name, start, len, values );
+  int error = GU_TIMED( name, GRBsetdblattrarray( model, name, start, len, values ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -391,14 +877,15 @@ CAMLprim value gu_get_float_attr_array( value v_model, value v_name, value v_sta
   int start = Int_val( v_start );
   int len = Int_val( v_len );
 
-  long ba_length = len - start;
-  if ( ba_length <= 0 ) {
+  // len is the number of elements, not the end of the range
+  long ba_length = len;
+  if ( start < 0 || ba_length <= 0 ) {
     caml_invalid_argument( "get_float_attr_array:(start,len)" );
   }
   else {
     v_array = caml_ba_alloc_dims(CAML_BA_FLOAT64 | CAML_BA_C_LAYOUT, 1, NULL, ba_length);
     double* array = Caml_ba_data_val(v_array);
-    int error = GRBgetdblattrarray( model, name, start, len, array );
+    int error = GU_TIMED( name, GRBgetdblattrarray( model, name, start, len, array ) );
 
     if ( error == 0 ) {
       // Ok v_array
@@ -414,6 +901,44 @@ CAMLprim value gu_get_float_attr_array( value v_model, value v_name, value v_sta
   }
 }
 
+// write into a caller-supplied bigarray, starting at offset, rather
+// than allocating a new one
+CAMLprim value gu_get_float_attr_array_into(
+  value v_model,
+  value v_name,
+  value v_start,
+  value v_len,
+  value v_dst,
+  value v_offset
+)
+{
+  CAMLparam5( v_model, v_name, v_start, v_len, v_dst );
+  CAMLxparam1( v_offset );
+  GRBmodel* model = model_val( v_model );
+  const char* name = String_val( v_name );
+  int start = Int_val( v_start );
+  int len = Int_val( v_len );
+  double* dst = get_ba_range( v_dst, CAML_BA_FLOAT64, Long_val( v_offset ), len );
+  if ( start < 0 || dst == NULL ) {
+    caml_invalid_argument( "get_float_attr_array_into:(start,len,dst,offset)" );
+  }
+  int error = GU_TIMED( name, GRBgetdblattrarray( model, name, start, len, dst ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_get_float_attr_array_into_bc( value* v_args, int arg_n )
+{
+  assert( arg_n == 6 );
+  return gu_get_float_attr_array_into(
+    v_args[0],
+    v_args[1],
+    v_args[2],
+    v_args[3],
+    v_args[4],
+    v_args[5]
+  );
+}
+
 // set and get int attribute array
 CAMLprim value gu_set_int_attr_array(
   value v_model, 
@@ -429,7 +954,7 @@ CAMLprim value gu_set_int_attr_array(
   int start = Int_val(v_start);
   int len = Int_val(v_len);
   int* values = get_i32a(v_values, len);
-  int error = GRBsetintattrarray( model, name, start, len, values );
+  int error = GU_TIMED( name, GRBsetintattrarray( model, name, start, len, values ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -442,14 +967,15 @@ CAMLprim value gu_get_int_attr_array( value v_model, value v_name, value v_start
   int start = Int_val( v_start );
   int len = Int_val( v_len );
 
-  long ba_length = len - start;
-  if ( ba_length <= 0 ) {
+  // len is the number of elements, not the end of the range
+  long ba_length = len;
+  if ( start < 0 || ba_length <= 0 ) {
     caml_invalid_argument( "get_int_attr_array:(start,len)" );
   }
   else {
     v_array = caml_ba_alloc_dims(CAML_BA_INT32 | CAML_BA_C_LAYOUT, 1, NULL, ba_length);
     int* array = Caml_ba_data_val(v_array);
-    int error = GRBgetintattrarray( model, name, start, len, array );
+    int error = GU_TIMED( name, GRBgetintattrarray( model, name, start, len, array ) );
 
     if ( error == 0 ) {
       // Ok v_array
@@ -465,6 +991,44 @@ CAMLprim value gu_get_int_attr_array( value v_model, value v_name, value v_start
   }
 }
 
+// write into a caller-supplied bigarray, starting at offset, rather
+// than allocating a new one
+CAMLprim value gu_get_int_attr_array_into(
+  value v_model,
+  value v_name,
+  value v_start,
+  value v_len,
+  value v_dst,
+  value v_offset
+)
+{
+  CAMLparam5( v_model, v_name, v_start, v_len, v_dst );
+  CAMLxparam1( v_offset );
+  GRBmodel* model = model_val( v_model );
+  const char* name = String_val( v_name );
+  int start = Int_val( v_start );
+  int len = Int_val( v_len );
+  int* dst = get_ba_range( v_dst, CAML_BA_INT32, Long_val( v_offset ), len );
+  if ( start < 0 || dst == NULL ) {
+    caml_invalid_argument( "get_int_attr_array_into:(start,len,dst,offset)" );
+  }
+  int error = GU_TIMED( name, GRBgetintattrarray( model, name, start, len, dst ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_get_int_attr_array_into_bc( value* v_args, int arg_n )
+{
+  assert( arg_n == 6 );
+  return gu_get_int_attr_array_into(
+    v_args[0],
+    v_args[1],
+    v_args[2],
+    v_args[3],
+    v_args[4],
+    v_args[5]
+  );
+}
+
 // set and get char attribute array
 
 CAMLprim value gu_set_char_attr_array(
@@ -481,7 +1045,7 @@ CAMLprim value gu_set_char_attr_array(
   int start = Int_val(v_start);
   int len = Int_val(v_len);
   char* values = get_ca(v_values, len);
-  int error = GRBsetcharattrarray( model, name, start, len, values );
+  int error = GU_TIMED( name, GRBsetcharattrarray( model, name, start, len, values ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -494,14 +1058,15 @@ CAMLprim value gu_get_char_attr_array( value v_model, value v_name, value v_star
   int start = Int_val( v_start );
   int len = Int_val( v_len );
 
-  long ba_length = len - start;
-  if ( ba_length <= 0 ) {
+  // len is the number of elements, not the end of the range
+  long ba_length = len;
+  if ( start < 0 || ba_length <= 0 ) {
     caml_invalid_argument( "get_char_attr_array:(start,len)" );
   }
   else {
     v_array = caml_ba_alloc_dims(CAML_BA_CHAR | CAML_BA_C_LAYOUT, 1, NULL, ba_length);
     char* array = Caml_ba_data_val(v_array);
-    int error = GRBgetcharattrarray( model, name, start, len, array );
+    int error = GU_TIMED( name, GRBgetcharattrarray( model, name, start, len, array ) );
 
     if ( error == 0 ) {
       // Ok v_array
@@ -517,6 +1082,44 @@ CAMLprim value gu_get_char_attr_array( value v_model, value v_name, value v_star
   }
 }
 
+// write into a caller-supplied bigarray, starting at offset, rather
+// than allocating a new one
+CAMLprim value gu_get_char_attr_array_into(
+  value v_model,
+  value v_name,
+  value v_start,
+  value v_len,
+  value v_dst,
+  value v_offset
+)
+{
+  CAMLparam5( v_model, v_name, v_start, v_len, v_dst );
+  CAMLxparam1( v_offset );
+  GRBmodel* model = model_val( v_model );
+  const char* name = String_val( v_name );
+  int start = Int_val( v_start );
+  int len = Int_val( v_len );
+  char* dst = get_ba_range( v_dst, CAML_BA_CHAR, Long_val( v_offset ), len );
+  if ( start < 0 || dst == NULL ) {
+    caml_invalid_argument( "get_char_attr_array_into:(start,len,dst,offset)" );
+  }
+  int error = GU_TIMED( name, GRBgetcharattrarray( model, name, start, len, dst ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_get_char_attr_array_into_bc( value* v_args, int arg_n )
+{
+  assert( arg_n == 6 );
+  return gu_get_char_attr_array_into(
+    v_args[0],
+    v_args[1],
+    v_args[2],
+    v_args[3],
+    v_args[4],
+    v_args[5]
+  );
+}
+
 // get string attribute array
 CAMLprim value gu_get_str_attr_array( value v_model, value v_name, value v_start, value v_len )
 {
@@ -526,9 +1129,15 @@ CAMLprim value gu_get_str_attr_array( value v_model, value v_name, value v_start
   const char* name = String_val( v_name );
   int start = Int_val( v_start );
   int len = Int_val( v_len );
-  int c_len = len - start;
-  char** array = malloc( c_len * sizeof(char*) );
-  int error = GRBgetstrattrarray( model, name, start, len, array );
+  // len is the number of elements, not the end of the range
+  if ( start < 0 || len <= 0 ) {
+    caml_invalid_argument( "get_str_attr_array:(start,len)" );
+  }
+  char** array = malloc( len * sizeof(char*) );
+  if ( array == NULL ) {
+    caml_raise_out_of_memory();
+  }
+  int error = GU_TIMED( name, GRBgetstrattrarray( model, name, start, len, array ) );
   if ( error == 0 ) {
     // Ok v_array
     v_array = caml_alloc( len, 0 );
@@ -547,51 +1156,339 @@ CAMLprim value gu_get_str_attr_array( value v_model, value v_name, value v_start
   CAMLreturn( v_res );
 }
 
-// create a new model
-CAMLprim value gu_new_model(
- value v_env,
- value v_name_opt,
- value v_num_vars,
- value v_objective_opt,
- value v_lower_bound_opt,
- value v_upper_bound_opt,
- value v_var_type_opt,
- value v_var_names_opt
-)
-
+// get string attribute array, packed: a single char bigarray holding
+// the NUL-terminated strings back to back, and their offsets in it
+CAMLprim value gu_get_str_attr_array_packed( value v_model, value v_name, value v_start, value v_len )
 {
-  CAMLparam5( v_env, v_name_opt, v_num_vars, v_objective_opt, v_lower_bound_opt );
-  CAMLxparam3( v_upper_bound_opt, v_var_type_opt, v_var_names_opt );
-  CAMLlocal5( v_model, v_res, v_var_names, v_objective, v_lower_bound );
-  CAMLlocal3( v_upper_bound, v_var_type, v_name );
+  CAMLparam4( v_model, v_name, v_start, v_len );
+  CAMLlocal4( v_data, v_offsets, v_packed, v_res );
+  GRBmodel* model = model_val( v_model );
+  const char* name = String_val( v_name );
+  int start = Int_val( v_start );
+  int len = Int_val( v_len );
+  if ( start < 0 || len <= 0 ) {
+    caml_invalid_argument( "get_str_attr_array_packed:(start,len)" );
+  }
+  char** array = malloc( len * sizeof(char*) );
+  if ( array == NULL ) {
+    caml_raise_out_of_memory();
+  }
+  int error = GU_TIMED( name, GRBgetstrattrarray( model, name, start, len, array ) );
+  if ( error == 0 ) {
+    size_t size = 0;
+    for ( int i = 0; i < len; i++ ) {
+      size += strlen( array[i] ) + 1;
+    }
+    if ( size > INT32_MAX ) {
+      free( array );
+      caml_invalid_argument( "get_str_attr_array_packed:size" );
+    }
+    v_data = caml_ba_alloc_dims( CAML_BA_CHAR | CAML_BA_C_LAYOUT, 1, NULL, (intnat)size );
+    v_offsets = caml_ba_alloc_dims( CAML_BA_INT32 | CAML_BA_C_LAYOUT, 1, NULL, (intnat)len );
+    char* data = Caml_ba_data_val( v_data );
+    int32_t* offsets = Caml_ba_data_val( v_offsets );
+    size_t pos = 0;
+    for ( int i = 0; i < len; i++ ) {
+      size_t n = strlen( array[i] ) + 1;
+      memcpy( data + pos, array[i], n );
+      offsets[i] = pos;
+      pos += n;
+    }
+    // { data; offsets }
+    v_packed = caml_alloc( 2, 0 );
+    Store_field( v_packed, 0, v_data );
+    Store_field( v_packed, 1, v_offsets );
+    // Ok v_packed
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, v_packed );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  free( array );
+  CAMLreturn( v_res );
+}
 
-  GRBenv* env = env_val( v_env );
+// log buffers
 
-  // name, optional
-  const char* name = NULL;
-  if ( Is_some( v_name_opt ) ) {
-    v_name = Some_val( v_name_opt );
-    name = String_val( v_name );
+CAMLprim value gu_log_buffer_create( value v_capacity )
+{
+  CAMLparam1( v_capacity );
+  CAMLlocal1( v_buf );
+  long capacity = Long_val( v_capacity );
+  if ( capacity < 64 || capacity > (1L << 40) ) {
+    caml_invalid_argument( "log_buffer_create:capacity" );
+  }
+  // round up to a power of 2, so that positions wrap with a mask
+  size_t size = 64;
+  while ( size < (size_t)capacity ) {
+    size <<= 1;
   }
 
-  // number of variables
-  int num_vars = Int_val( v_num_vars );
+  v_buf = caml_alloc_custom( &logring_ops, sizeof(struct gu_logring*), 0, 1 );
+  logring_val( v_buf ) = NULL;
+  struct gu_logring* ring = malloc( sizeof(struct gu_logring) );
+  char* data = malloc( size );
+  if ( ring == NULL || data == NULL ) {
+    free( ring );
+    free( data );
+    caml_raise_out_of_memory();
+  }
+  ring->data = data;
+  ring->mask = size - 1;
+  atomic_init( &ring->head, 0 );
+  atomic_init( &ring->tail, 0 );
+  atomic_init( &ring->dropped, 0 );
+  atomic_flag_clear( &ring->producing );
+  logring_val( v_buf ) = ring;
+  CAMLreturn( v_buf );
+}
 
-  // objective
-  double* objective = NULL;
-  if ( Is_some( v_objective_opt ) ) {
-    v_objective = Some_val( v_objective_opt );
-    objective = get_fa( v_objective, num_vars );
-    if ( objective == NULL ) {
-      caml_invalid_argument( "new_model:objective" );
-    }
+static void logring_copy_in( struct gu_logring* ring, size_t pos, const char* src, size_t len )
+{
+  size_t at = pos & ring->mask;
+  size_t first = ring->mask + 1 - at;
+  if ( first > len ) {
+    first = len;
   }
+  memcpy( ring->data + at, src, first );
+  memcpy( ring->data, src + first, len - first );
+}
 
-  // lower bound
-  double* lower_bound = NULL;
-  if ( Is_some( v_lower_bound_opt ) ) {
-    v_lower_bound = Some_val( v_lower_bound_opt );
-    lower_bound = get_fa( v_lower_bound, num_vars );
+static void logring_copy_out( struct gu_logring* ring, size_t pos, char* dst, size_t len )
+{
+  size_t at = pos & ring->mask;
+  size_t first = ring->mask + 1 - at;
+  if ( first > len ) {
+    first = len;
+  }
+  memcpy( dst, ring->data + at, first );
+  memcpy( dst + first, ring->data, len - first );
+}
+
+// Gurobi's log callback: runs on whatever thread Gurobi logs from,
+// without the runtime lock
+static int __stdcall gu_log_trampoline( char* msg, void* logdata )
+{
+  struct gu_logring* ring = logdata;
+  size_t len = strlen( msg );
+  size_t need = sizeof(uint32_t) + len;
+
+  while ( atomic_flag_test_and_set_explicit( &ring->producing, memory_order_acquire ) ) {
+    // another producer is copying its message; this is short
+  }
+  size_t head = atomic_load_explicit( &ring->head, memory_order_relaxed );
+  size_t tail = atomic_load_explicit( &ring->tail, memory_order_acquire );
+  if ( len > UINT32_MAX || need > ring->mask + 1 - (head - tail) ) {
+    atomic_fetch_add_explicit( &ring->dropped, 1, memory_order_relaxed );
+  }
+  else {
+    uint32_t len32 = len;
+    logring_copy_in( ring, head, (const char*)&len32, sizeof(uint32_t) );
+    logring_copy_in( ring, head + sizeof(uint32_t), msg, len );
+    atomic_store_explicit( &ring->head, head + need, memory_order_release );
+  }
+  atomic_flag_clear_explicit( &ring->producing, memory_order_release );
+  return 0;
+}
+
+// remove up to v_max messages from the buffer, oldest first
+CAMLprim value gu_log_buffer_drain( value v_buf, value v_max )
+{
+  CAMLparam2( v_buf, v_max );
+  CAMLlocal2( v_msgs, v_msg );
+  struct gu_logring* ring = logring_val( v_buf );
+  long max = Long_val( v_max );
+
+  // count the messages available, up to max
+  size_t tail = atomic_load_explicit( &ring->tail, memory_order_relaxed );
+  size_t head = atomic_load_explicit( &ring->head, memory_order_acquire );
+  long n = 0;
+  for ( size_t pos = tail; pos != head && n < max; n++ ) {
+    uint32_t len;
+    logring_copy_out( ring, pos, (char*)&len, sizeof(uint32_t) );
+    pos += sizeof(uint32_t) + len;
+  }
+
+  v_msgs = caml_alloc( n, 0 );
+  for ( long i = 0; i < n; i++ ) {
+    uint32_t len;
+    logring_copy_out( ring, tail, (char*)&len, sizeof(uint32_t) );
+    v_msg = caml_alloc_string( len );
+    logring_copy_out( ring, tail + sizeof(uint32_t), (char*)Bytes_val( v_msg ), len );
+    Store_field( v_msgs, i, v_msg );
+    tail += sizeof(uint32_t) + len;
+    // release the space as we go, so that producers can reuse it
+    atomic_store_explicit( &ring->tail, tail, memory_order_release );
+  }
+  CAMLreturn( v_msgs );
+}
+
+CAMLprim value gu_log_buffer_dropped( value v_buf )
+{
+  CAMLparam1( v_buf );
+  struct gu_logring* ring = logring_val( v_buf );
+  CAMLreturn( Val_long( atomic_load( &ring->dropped ) ) );
+}
+
+CAMLprim value gu_set_log_buffer( value v_env, value v_buf_opt )
+{
+  CAMLparam2( v_env, v_buf_opt );
+  GRBenv* env = env_val( v_env );
+  int error;
+  if ( Is_some( v_buf_opt ) ) {
+    struct gu_logring* ring = logring_val( Some_val( v_buf_opt ) );
+    error = GU_TIMED( NULL, GRBsetlogcallbackfuncenv( env, gu_log_trampoline, ring ) );
+    if ( error == 0 ) {
+      set_root( &env_block( v_env )->log_buffer, Some_val( v_buf_opt ) );
+    }
+  }
+  else {
+    error = GU_TIMED( NULL, GRBsetlogcallbackfuncenv( env, NULL, NULL ) );
+    if ( error == 0 ) {
+      set_root( &env_block( v_env )->log_buffer, Val_unit );
+    }
+  }
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_set_model_log_buffer( value v_model, value v_buf_opt )
+{
+  CAMLparam2( v_model, v_buf_opt );
+  GRBmodel* model = model_val( v_model );
+  int error;
+  if ( Is_some( v_buf_opt ) ) {
+    struct gu_logring* ring = logring_val( Some_val( v_buf_opt ) );
+    error = GU_TIMED( NULL, GRBsetlogcallbackfunc( model, gu_log_trampoline, ring ) );
+    if ( error == 0 ) {
+      set_root( &model_block( v_model )->log_buffer, Some_val( v_buf_opt ) );
+    }
+  }
+  else {
+    error = GU_TIMED( NULL, GRBsetlogcallbackfunc( model, NULL, NULL ) );
+    if ( error == 0 ) {
+      set_root( &model_block( v_model )->log_buffer, Val_unit );
+    }
+  }
+  CAMLreturn( Val_int( error ) );
+}
+
+// set MIP start number start_number, either for variables 0 to
+// num - 1, or, when v_ind_opt is provided, for the num variables it
+// lists; the Start attribute of other variables is left untouched.
+// NumStart is grown as needed.
+CAMLprim value gu_set_mip_start(
+  value v_model,
+  value v_start_number,
+  value v_num,
+  value v_ind_opt,
+  value v_values
+)
+{
+  CAMLparam5( v_model, v_start_number, v_num, v_ind_opt, v_values );
+  CAMLlocal1( v_ind );
+  GRBmodel* model = model_val( v_model );
+  int start_number = Int_val( v_start_number );
+  int num = Int_val( v_num );
+  if ( start_number < 0 ) {
+    caml_invalid_argument( "set_mip_start:start_number" );
+  }
+
+  int* ind = NULL;
+  if ( Is_some( v_ind_opt ) ) {
+    v_ind = Some_val( v_ind_opt );
+    ind = get_i32a( v_ind, num );
+    if ( ind == NULL ) {
+      caml_invalid_argument( "set_mip_start:ind" );
+    }
+  }
+  double* values = get_fa( v_values, num );
+  if ( values == NULL ) {
+    caml_invalid_argument( "set_mip_start:values" );
+  }
+
+  int num_start = 0;
+  int error = GU_TIMED( GRB_INT_ATTR_NUMSTART, GRBgetintattr( model, GRB_INT_ATTR_NUMSTART, &num_start ) );
+  if ( error == 0 && start_number >= num_start ) {
+    error = GU_TIMED( GRB_INT_ATTR_NUMSTART, GRBsetintattr( model, GRB_INT_ATTR_NUMSTART, start_number + 1 ) );
+    if ( error == 0 ) {
+      error = GU_TIMED( NULL, GRBupdatemodel( model ) );
+    }
+  }
+  // StartNumber selects the start that Start refers to; its previous
+  // value is restored afterwards
+  GRBenv* env = GRBgetenv( model );
+  assert( env != NULL );
+  int prev_start_number = 0;
+  if ( error == 0 ) {
+    error = GU_TIMED( GRB_INT_PAR_STARTNUMBER, GRBgetintparam( env, GRB_INT_PAR_STARTNUMBER, &prev_start_number ) );
+  }
+  if ( error == 0 ) {
+    error = GU_TIMED( GRB_INT_PAR_STARTNUMBER, GRBsetintparam( env, GRB_INT_PAR_STARTNUMBER, start_number ) );
+    if ( error == 0 ) {
+      if ( ind == NULL ) {
+        error = GU_TIMED( GRB_DBL_ATTR_START, GRBsetdblattrarray( model, GRB_DBL_ATTR_START, 0, num, values ) );
+      }
+      else {
+        error = GU_TIMED( GRB_DBL_ATTR_START, GRBsetdblattrlist( model, GRB_DBL_ATTR_START, num, ind, values ) );
+      }
+      int restore_error = GU_TIMED( GRB_INT_PAR_STARTNUMBER,
+                                   GRBsetintparam( env, GRB_INT_PAR_STARTNUMBER, prev_start_number ) );
+      if ( error == 0 ) {
+        error = restore_error;
+      }
+    }
+  }
+  CAMLreturn( Val_int( error ) );
+}
+
+// create a new model
+static value new_model(
+ value v_env,
+ value v_name_opt,
+ value v_num_vars,
+ value v_objective_opt,
+ value v_lower_bound_opt,
+ value v_upper_bound_opt,
+ value v_var_type_opt,
+ value v_var_names_opt,
+ int packed_names
+)
+{
+  CAMLparam5( v_env, v_name_opt, v_num_vars, v_objective_opt, v_lower_bound_opt );
+  CAMLxparam3( v_upper_bound_opt, v_var_type_opt, v_var_names_opt );
+  CAMLlocal5( v_model, v_res, v_var_names, v_objective, v_lower_bound );
+  CAMLlocal3( v_upper_bound, v_var_type, v_name );
+
+  GRBenv* env = env_val( v_env );
+
+  // name, optional
+  const char* name = NULL;
+  if ( Is_some( v_name_opt ) ) {
+    v_name = Some_val( v_name_opt );
+    name = String_val( v_name );
+  }
+
+  // number of variables
+  int num_vars = Int_val( v_num_vars );
+
+  // objective
+  double* objective = NULL;
+  if ( Is_some( v_objective_opt ) ) {
+    v_objective = Some_val( v_objective_opt );
+    objective = get_fa( v_objective, num_vars );
+    if ( objective == NULL ) {
+      caml_invalid_argument( "new_model:objective" );
+    }
+  }
+
+  // lower bound
+  double* lower_bound = NULL;
+  if ( Is_some( v_lower_bound_opt ) ) {
+    v_lower_bound = Some_val( v_lower_bound_opt );
+    lower_bound = get_fa( v_lower_bound, num_vars );
     if ( lower_bound == NULL ) {
       caml_invalid_argument( "new_model:lower_bound" );
     }
@@ -621,15 +1518,15 @@ CAMLprim value gu_new_model(
   const char** var_names = NULL;
   if ( Is_some( v_var_names_opt ) ) {
     v_var_names = Some_val( v_var_names_opt );
-    var_names = get_sa( v_var_names, num_vars );
+    var_names = get_names( v_var_names, num_vars, packed_names );
     if ( var_names == NULL ) {
-      caml_invalid_argument( "new_mode:var_names" );
+      caml_invalid_argument( "new_model:var_names" );
     }
   }
 
   GRBmodel* model;
 
-  int error = GRBnewmodel( env,
+  int error = GU_TIMED( NULL, GRBnewmodel( env,
 			   &model,
 			   name,
 			   num_vars,
@@ -637,15 +1534,13 @@ CAMLprim value gu_new_model(
 			   lower_bound,
 			   upper_bound,
 			   var_type,
-			   (char**)var_names );
+			   (char**)var_names ) );
   
-  if ( Is_some( v_var_names ) ) {
-    free( var_names );
-  }
+  free( var_names );
 
   if ( error == 0 ) {
-    v_model = caml_alloc_custom(&model_ops, sizeof(GRBmodel*), 0, 1);
-    model_val(v_model) = model;
+    // the model may inherit the log callback of its environment
+    v_model = alloc_model( model, v_env, env_block(v_env)->log_buffer );
 
     // Ok model
     v_res = caml_alloc(1, 0);
@@ -660,7 +1555,31 @@ CAMLprim value gu_new_model(
 }
 
 
-// create a new model (bytecode support)
+// create a new model, with names as a string array, or packed
+CAMLprim value gu_new_model(
+ value v_env,
+ value v_name_opt,
+ value v_num_vars,
+ value v_objective_opt,
+ value v_lower_bound_opt,
+ value v_upper_bound_opt,
+ value v_var_type_opt,
+ value v_var_names_opt
+)
+{
+  return new_model(
+		      v_env,
+		      v_name_opt,
+		      v_num_vars,
+		      v_objective_opt,
+		      v_lower_bound_opt,
+		      v_upper_bound_opt,
+		      v_var_type_opt,
+		      v_var_names_opt,
+		      0
+		      );
+}
+
 CAMLprim value gu_new_model_bc(value* v_args, int arg_n )
 {
   assert( arg_n == 8 );
@@ -676,6 +1595,45 @@ CAMLprim value gu_new_model_bc(value* v_args, int arg_n )
 		      );
 }
 
+CAMLprim value gu_new_model_packed(
+ value v_env,
+ value v_name_opt,
+ value v_num_vars,
+ value v_objective_opt,
+ value v_lower_bound_opt,
+ value v_upper_bound_opt,
+ value v_var_type_opt,
+ value v_var_names_opt
+)
+{
+  return new_model(
+		      v_env,
+		      v_name_opt,
+		      v_num_vars,
+		      v_objective_opt,
+		      v_lower_bound_opt,
+		      v_upper_bound_opt,
+		      v_var_type_opt,
+		      v_var_names_opt,
+		      1
+		      );
+}
+
+CAMLprim value gu_new_model_packed_bc(value* v_args, int arg_n )
+{
+  assert( arg_n == 8 );
+  return gu_new_model_packed(
+		      v_args[0],
+		      v_args[1],
+		      v_args[2],
+		      v_args[3],
+		      v_args[4],
+		      v_args[5],
+		      v_args[6],
+		      v_args[7]
+		      );
+}
+
 // create a model from a file
 CAMLprim value gu_read_model( value v_env, value v_path )
 {
@@ -687,12 +1645,23 @@ CAMLprim value gu_read_model( value v_env, value v_path )
   // we have to check the existance of the file because GRBreadmodel()
   // does not do it, resulting in bus errors when the path is long
   if (access(path, F_OK) == 0) {
-    // file exists
+    // file exists. Parsing may take a while, so we do it without the
+    // runtime lock; the path is copied out of the OCaml heap first,
+    // since the string may move while the lock is released.
+    char* c_path = strdup( path );
+    if ( c_path == NULL ) {
+      caml_raise_out_of_memory();
+    }
     GRBmodel* model = NULL;
-    int error = GRBreadmodel( env, path, &model );
+    hold( env_block(v_env) );
+    caml_enter_blocking_section();
+    int error = GU_TIMED( NULL, GRBreadmodel( env, c_path, &model ) );
+    caml_leave_blocking_section();
+    unhold( env_block(v_env) );
+    free( c_path );
     if ( error == 0 ) {
-      v_model = caml_alloc_custom(&model_ops, sizeof(void*), 0, 1);
-      model_val(v_model) = model;
+      // the model may inherit the log callback of its environment
+      v_model = alloc_model( model, v_env, env_block(v_env)->log_buffer );
 
       // Ok model
       v_res = caml_alloc(1, 0);
@@ -717,7 +1686,7 @@ CAMLprim value gu_reset_model(value v_model)
 {
   CAMLparam1( v_model );
   GRBmodel* model = model_val(v_model);
-  int error = GRBresetmodel( model );
+  int error = GU_TIMED( NULL, GRBresetmodel( model ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -725,21 +1694,56 @@ CAMLprim value gu_update_model(value v_model)
 {
   CAMLparam1( v_model );
   GRBmodel* model = model_val(v_model);
-  int error = GRBupdatemodel( model );
+  int error = GU_TIMED( NULL, GRBupdatemodel( model ) );
+  refresh_model_mem( model_block(v_model) );
   CAMLreturn( Val_int( error ) );
 }
 
+// free a model, or an env, now; their handles may not be used
+// afterwards. Freeing twice is harmless, but freeing one that is held
+// by a call in progress on another thread is refused.
+CAMLprim value gu_free_model(value v_model)
+{
+  CAMLparam1( v_model );
+  if ( model_block(v_model)->busy > 0 ) {
+    caml_invalid_argument( "free_model: model is in use" );
+  }
+  dispose_model( model_block(v_model) );
+  CAMLreturn( Val_unit );
+}
+
+CAMLprim value gu_free_env(value v_env)
+{
+  CAMLparam1( v_env );
+  struct gu_env* block = env_block(v_env);
+  if ( block->num_models > 0 ) {
+    caml_invalid_argument( "free_env: models of env have not been freed" );
+  }
+  if ( block->busy > 0 ) {
+    caml_invalid_argument( "free_env: env is in use" );
+  }
+  if ( block->env != NULL ) {
+    GRBfreeenv( block->env );
+    block->env = NULL;
+  }
+  set_root( &block->log_buffer, Val_unit );
+  CAMLreturn( Val_unit );
+}
+
 CAMLprim value gu_copy_model(value v_model)
 {
   CAMLparam1( v_model );
   CAMLlocal2( v_new_model, v_res );
   GRBmodel* model = model_val(v_model);
-  GRBmodel* new_model = GRBcopymodel( model );
+  GRBmodel* new_model = NULL;
+  GU_TIMED( NULL, (new_model = GRBcopymodel( model )) == NULL ? GRB_ERROR_OUT_OF_MEMORY : 0 );
   if (new_model == NULL){
     v_res = Val_none;
   } else {
-    v_new_model = caml_alloc_custom(&model_ops, sizeof(void*), 0, 1);
-    model_val(v_new_model) = new_model;
+    // the callback, if any, belongs to the original model
+    GU_TIMED( NULL, GRBsetcallbackfunc( new_model, NULL, NULL ) );
+    // ... but the log callback may be copied
+    v_new_model = alloc_model( new_model, *model_block(v_model)->env, model_block(v_model)->log_buffer );
 
     v_res = caml_alloc_some( v_new_model );
   }
@@ -755,7 +1759,7 @@ CAMLprim value gu_set_float_attr_element(value v_model, value v_name, value v_el
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   double new_value = Double_val(v_new_value);
-  int error = GRBsetdblattrelement( model, name, element, new_value );
+  int error = GU_TIMED( name, GRBsetdblattrelement( model, name, element, new_value ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -767,7 +1771,7 @@ CAMLprim value gu_get_float_attr_element(value v_model, value v_name, value v_el
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   double d;
-  int error = GRBgetdblattrelement( model, name, element, &d );
+  int error = GU_TIMED( name, GRBgetdblattrelement( model, name, element, &d ) );
   if ( error == 0 ) {
     // Ok s
     v_res = caml_alloc(1, 0);
@@ -789,7 +1793,7 @@ CAMLprim value gu_set_str_attr_element(value v_model, value v_name, value v_elem
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   const char* new_value = String_val(v_new_value);
-  int error = GRBsetstrattrelement( model, name, element, new_value );
+  int error = GU_TIMED( name, GRBsetstrattrelement( model, name, element, new_value ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -801,7 +1805,7 @@ CAMLprim value gu_get_str_attr_element(value v_model, value v_name, value v_elem
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   char* s;
-  int error = GRBgetstrattrelement( model, name, element, &s );
+  int error = GU_TIMED( name, GRBgetstrattrelement( model, name, element, &s ) );
   if ( error == 0 ) {
     // Ok s
     v_res = caml_alloc(1, 0);
@@ -823,7 +1827,7 @@ CAMLprim value gu_set_char_attr_element(value v_model, value v_name, value v_ele
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   char new_value = Int_val(v_new_value);
-  int error = GRBsetcharattrelement( model, name, element, new_value );
+  int error = GU_TIMED( name, GRBsetcharattrelement( model, name, element, new_value ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -835,7 +1839,7 @@ CAMLprim value gu_get_char_attr_element(value v_model, value v_name, value v_ele
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   char c;
-  int error = GRBgetcharattrelement( model, name, element, &c );
+  int error = GU_TIMED( name, GRBgetcharattrelement( model, name, element, &c ) );
   if ( error == 0 ) {
     // Ok s
     v_res = caml_alloc(1, 0);
@@ -857,7 +1861,7 @@ CAMLprim value gu_set_int_attr_element(value v_model, value v_name, value v_elem
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   int new_value = Int_val(v_new_value);
-  int error = GRBsetintattrelement( model, name, element, new_value );
+  int error = GU_TIMED( name, GRBsetintattrelement( model, name, element, new_value ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -869,7 +1873,7 @@ CAMLprim value gu_get_int_attr_element(value v_model, value v_name, value v_elem
   const char* name = String_val(v_name);
   int element = Int_val(v_element);
   int i;
-  int error = GRBgetintattrelement( model, name, element, &i );
+  int error = GU_TIMED( name, GRBgetintattrelement( model, name, element, &i ) );
   if ( error == 0 ) {
     // Ok s
     v_res = caml_alloc(1, 0);
@@ -883,111 +1887,341 @@ CAMLprim value gu_get_int_attr_element(value v_model, value v_name, value v_elem
   CAMLreturn( v_res );
 }
 
-// set and get a float attribute
-CAMLprim value gu_set_float_attr(value v_model, value v_name, value v_new_value )
+// set and get an attribute for a list of elements, given by their
+// indices, in a single call; getters write into the values array
+CAMLprim value gu_set_float_attr_list(
+  value v_model,
+  value v_name,
+  value v_num,
+  value v_ind,
+  value v_values
+)
 {
-  CAMLparam3( v_model, v_name, v_new_value );
+  CAMLparam5( v_model, v_name, v_num, v_ind, v_values );
   GRBmodel* model = model_val(v_model);
   const char* name = String_val(v_name);
-  double new_value = Double_val(v_new_value);
-  int error = GRBsetdblattr( model, name, new_value );
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "set_float_attr_list:num" );
+  }
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "set_float_attr_list:ind" );
+  }
+  double* values = get_fa(v_values, num);
+  if ( values == NULL ) {
+    caml_invalid_argument( "set_float_attr_list:values" );
+  }
+  int error = GU_TIMED( name, GRBsetdblattrlist( model, name, num, ind, values ) );
   CAMLreturn( Val_int( error ) );
 }
 
-CAMLprim value gu_get_float_attr( value v_model, value v_name )
+CAMLprim value gu_get_float_attr_list(
+  value v_model,
+  value v_name,
+  value v_num,
+  value v_ind,
+  value v_values
+)
 {
-  CAMLparam2( v_model, v_name );
-  CAMLlocal2( v_res, v_s );
+  CAMLparam5( v_model, v_name, v_num, v_ind, v_values );
   GRBmodel* model = model_val(v_model);
   const char* name = String_val(v_name);
-  double d;
-  int error = GRBgetdblattr( model, name, &d );
-  if ( error == 0 ) {
-    // Ok s
-    v_res = caml_alloc(1, 0);
-    Store_field( v_res, 0, caml_copy_double(d) );
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "get_float_attr_list:num" );
   }
-  else {
-    // Error code
-    v_res = caml_alloc(1, 1);
-    Store_field( v_res, 0, Val_int(error) );
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "get_float_attr_list:ind" );
   }
-  CAMLreturn( v_res );
+  double* values = get_fa(v_values, num);
+  if ( values == NULL ) {
+    caml_invalid_argument( "get_float_attr_list:values" );
+  }
+  int error = GU_TIMED( name, GRBgetdblattrlist( model, name, num, ind, values ) );
+  CAMLreturn( Val_int( error ) );
 }
 
-// set and get a string attribute
-CAMLprim value gu_set_str_attr(value v_model, value v_name, value v_new_value )
+CAMLprim value gu_set_int_attr_list(
+  value v_model,
+  value v_name,
+  value v_num,
+  value v_ind,
+  value v_values
+)
 {
-  CAMLparam3( v_model, v_name, v_new_value );
+  CAMLparam5( v_model, v_name, v_num, v_ind, v_values );
   GRBmodel* model = model_val(v_model);
   const char* name = String_val(v_name);
-  const char* new_value = String_val(v_new_value);
-  int error = GRBsetstrattr( model, name, new_value );
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "set_int_attr_list:num" );
+  }
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "set_int_attr_list:ind" );
+  }
+  int* values = get_i32a(v_values, num);
+  if ( values == NULL ) {
+    caml_invalid_argument( "set_int_attr_list:values" );
+  }
+  int error = GU_TIMED( name, GRBsetintattrlist( model, name, num, ind, values ) );
   CAMLreturn( Val_int( error ) );
 }
 
-CAMLprim value gu_get_str_attr( value v_model, value v_name )
+CAMLprim value gu_get_int_attr_list(
+  value v_model,
+  value v_name,
+  value v_num,
+  value v_ind,
+  value v_values
+)
 {
-  CAMLparam2( v_model, v_name );
-  CAMLlocal2( v_res, v_s );
+  CAMLparam5( v_model, v_name, v_num, v_ind, v_values );
   GRBmodel* model = model_val(v_model);
   const char* name = String_val(v_name);
-  char* s;
-  int error = GRBgetstrattr( model, name, &s );
-  if ( error == 0 ) {
-    v_s = caml_copy_string( s );
-
-    // Ok s
-    v_res = caml_alloc(1, 0);
-    Store_field( v_res, 0, v_s );
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "get_int_attr_list:num" );
   }
-  else {
-    // Error code
-    v_res = caml_alloc(1, 1);
-    Store_field( v_res, 0, Val_int(error) );
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "get_int_attr_list:ind" );
   }
-  CAMLreturn( v_res );
+  int* values = get_i32a(v_values, num);
+  if ( values == NULL ) {
+    caml_invalid_argument( "get_int_attr_list:values" );
+  }
+  int error = GU_TIMED( name, GRBgetintattrlist( model, name, num, ind, values ) );
+  CAMLreturn( Val_int( error ) );
 }
 
-// set and get an int attribute
-CAMLprim value gu_set_int_attr(value v_model, value v_name, value v_new_value )
+CAMLprim value gu_set_char_attr_list(
+  value v_model,
+  value v_name,
+  value v_num,
+  value v_ind,
+  value v_values
+)
 {
-  CAMLparam3( v_model, v_name, v_new_value );
+  CAMLparam5( v_model, v_name, v_num, v_ind, v_values );
   GRBmodel* model = model_val(v_model);
   const char* name = String_val(v_name);
-  int new_value = Int_val(v_new_value);
-  int error = GRBsetintattr( model, name, new_value );
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "set_char_attr_list:num" );
+  }
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "set_char_attr_list:ind" );
+  }
+  char* values = get_ca(v_values, num);
+  if ( values == NULL ) {
+    caml_invalid_argument( "set_char_attr_list:values" );
+  }
+  int error = GU_TIMED( name, GRBsetcharattrlist( model, name, num, ind, values ) );
   CAMLreturn( Val_int( error ) );
 }
 
-CAMLprim value gu_get_int_attr( value v_model, value v_name )
+CAMLprim value gu_get_char_attr_list(
+  value v_model,
+  value v_name,
+  value v_num,
+  value v_ind,
+  value v_values
+)
 {
-  CAMLparam2( v_model, v_name );
-  CAMLlocal2( v_res, v_s );
+  CAMLparam5( v_model, v_name, v_num, v_ind, v_values );
   GRBmodel* model = model_val(v_model);
   const char* name = String_val(v_name);
-  int i;
-  int error = GRBgetintattr( model, name, &i );
-  if ( error == 0 ) {
-    // Ok s
-    v_res = caml_alloc(1, 0);
-    Store_field( v_res, 0, Val_int(i) );
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "get_char_attr_list:num" );
   }
-  else {
-    // Error code
-    v_res = caml_alloc(1, 1);
-    Store_field( v_res, 0, Val_int(error) );
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "get_char_attr_list:ind" );
   }
-  CAMLreturn( v_res );
+  char* values = get_ca(v_values, num);
+  if ( values == NULL ) {
+    caml_invalid_argument( "get_char_attr_list:values" );
+  }
+  int error = GU_TIMED( name, GRBgetcharattrlist( model, name, num, ind, values ) );
+  CAMLreturn( Val_int( error ) );
 }
 
-CAMLprim value gu_add_constrs(
+CAMLprim value gu_set_str_attr_list(
+  value v_model,
+  value v_name,
+  value v_num,
+  value v_ind,
+  value v_values
+)
+{
+  CAMLparam5( v_model, v_name, v_num, v_ind, v_values );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "set_str_attr_list:num" );
+  }
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "set_str_attr_list:ind" );
+  }
+  const char** values = get_sa(v_values, num);
+  if ( values == NULL ) {
+    caml_invalid_argument( "set_str_attr_list:values" );
+  }
+  int error = GU_TIMED( name, GRBsetstrattrlist( model, name, num, ind, (char**)values ) );
+  free(values);
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_get_str_attr_list( value v_model, value v_name, value v_num, value v_ind )
+{
+  CAMLparam4( v_model, v_name, v_num, v_ind );
+  CAMLlocal2( v_array, v_res );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  int num = Int_val(v_num);
+  if ( num < 0 ) {
+    caml_invalid_argument( "get_str_attr_list:num" );
+  }
+  int* ind = get_i32a(v_ind, num);
+  if ( ind == NULL ) {
+    caml_invalid_argument( "get_str_attr_list:ind" );
+  }
+  char** array = malloc( (num > 0 ? num : 1) * sizeof(char*) );
+  if ( array == NULL ) {
+    caml_raise_out_of_memory();
+  }
+  int error = GU_TIMED( name, GRBgetstrattrlist( model, name, num, ind, array ) );
+  if ( error == 0 ) {
+    // Ok v_array
+    v_array = caml_alloc( num, 0 );
+    for (int i = 0; i < num; i++ ) {
+      Store_field( v_array, i, caml_copy_string( array[i] ) );
+    }
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, v_array );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  free(array);
+  CAMLreturn( v_res );
+}
+
+// set and get a float attribute
+CAMLprim value gu_set_float_attr(value v_model, value v_name, value v_new_value )
+{
+  CAMLparam3( v_model, v_name, v_new_value );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  double new_value = Double_val(v_new_value);
+  int error = GU_TIMED( name, GRBsetdblattr( model, name, new_value ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_get_float_attr( value v_model, value v_name )
+{
+  CAMLparam2( v_model, v_name );
+  CAMLlocal2( v_res, v_s );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  double d;
+  int error = GU_TIMED( name, GRBgetdblattr( model, name, &d ) );
+  if ( error == 0 ) {
+    // Ok s
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, caml_copy_double(d) );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+// set and get a string attribute
+CAMLprim value gu_set_str_attr(value v_model, value v_name, value v_new_value )
+{
+  CAMLparam3( v_model, v_name, v_new_value );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  const char* new_value = String_val(v_new_value);
+  int error = GU_TIMED( name, GRBsetstrattr( model, name, new_value ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_get_str_attr( value v_model, value v_name )
+{
+  CAMLparam2( v_model, v_name );
+  CAMLlocal2( v_res, v_s );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  char* s;
+  int error = GU_TIMED( name, GRBgetstrattr( model, name, &s ) );
+  if ( error == 0 ) {
+    v_s = caml_copy_string( s );
+
+    // Ok s
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, v_s );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+// set and get an int attribute
+CAMLprim value gu_set_int_attr(value v_model, value v_name, value v_new_value )
+{
+  CAMLparam3( v_model, v_name, v_new_value );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  int new_value = Int_val(v_new_value);
+  int error = GU_TIMED( name, GRBsetintattr( model, name, new_value ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_get_int_attr( value v_model, value v_name )
+{
+  CAMLparam2( v_model, v_name );
+  CAMLlocal2( v_res, v_s );
+  GRBmodel* model = model_val(v_model);
+  const char* name = String_val(v_name);
+  int i;
+  int error = GU_TIMED( name, GRBgetintattr( model, name, &i ) );
+  if ( error == 0 ) {
+    // Ok s
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, Val_int(i) );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+static value add_constrs(
  value v_model,
  value v_num_constraints,
  value v_compressed_opt,
  value v_sense,
  value v_rhs,
- value v_constr_names_opt
+ value v_constr_names_opt,
+ int packed_names
 )
 {
   CAMLparam5( v_model, v_num_constraints, v_compressed_opt, v_sense, v_rhs );
@@ -1037,13 +2271,13 @@ CAMLprim value gu_add_constrs(
   const char** constr_names = NULL;
   if ( Is_some( v_constr_names_opt ) ) {
     v_constr_names = Some_val( v_constr_names_opt );
-    constr_names = get_sa( v_constr_names, num_constraints );
+    constr_names = get_names( v_constr_names, num_constraints, packed_names );
     if ( constr_names == NULL ) {
       caml_invalid_argument( "add_constrs:constr_names" );
     }
   }
 
-  int error = GRBaddconstrs( model,
+  int error = GU_TIMED( NULL, GRBaddconstrs( model,
 			     num_constraints,
 			     num_nz,
 			     c_beg,
@@ -1052,16 +2286,34 @@ CAMLprim value gu_add_constrs(
 			     sense,
 			     rhs,
 			     (char**)constr_names
-	                   );
+	                   ) );
 
-  if ( Is_some( v_constr_names ) ) {
-    free( constr_names );
-  }
+  free( constr_names );
 
   CAMLreturn( Val_int( error ) );
 }
   
 
+CAMLprim value gu_add_constrs(
+ value v_model,
+ value v_num_constraints,
+ value v_compressed_opt,
+ value v_sense,
+ value v_rhs,
+ value v_constr_names_opt
+)
+{
+  return add_constrs(
+		      v_model,
+		      v_num_constraints,
+		      v_compressed_opt,
+		      v_sense,
+		      v_rhs,
+		      v_constr_names_opt,
+		      0
+		      );
+}
+
 CAMLprim value gu_add_constrs_bc(value* v_args, int arg_n )
 {
   assert( arg_n == 6 );
@@ -1075,6 +2327,39 @@ CAMLprim value gu_add_constrs_bc(value* v_args, int arg_n )
 			);
 }  
 
+CAMLprim value gu_add_constrs_packed(
+ value v_model,
+ value v_num_constraints,
+ value v_compressed_opt,
+ value v_sense,
+ value v_rhs,
+ value v_constr_names_opt
+)
+{
+  return add_constrs(
+		      v_model,
+		      v_num_constraints,
+		      v_compressed_opt,
+		      v_sense,
+		      v_rhs,
+		      v_constr_names_opt,
+		      1
+		      );
+}
+
+CAMLprim value gu_add_constrs_packed_bc(value* v_args, int arg_n )
+{
+  assert( arg_n == 6 );
+  return gu_add_constrs_packed(
+		      v_args[0],
+		      v_args[1],
+		      v_args[2],
+		      v_args[3],
+		      v_args[4],
+		      v_args[5]
+		      );
+}
+
 CAMLprim value gu_del_constrs(
   value v_model, 
   value v_num_del,
@@ -1085,7 +2370,7 @@ CAMLprim value gu_del_constrs(
   GRBmodel* model = model_val(v_model);
   int num_del = Int_val(v_num_del);
   int* ind = get_i32a(v_ind, num_del);
-  int error = GRBdelconstrs( model, num_del, ind );
+  int error = GU_TIMED( NULL, GRBdelconstrs( model, num_del, ind ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1122,7 +2407,7 @@ CAMLprim value gu_add_constr(
     name = String_val( v_name );
   }
 
-  int error = GRBaddconstr( model, num_nz, c_ind, c_val, sense, rhs, name );
+  int error = GU_TIMED( NULL, GRBaddconstr( model, num_nz, c_ind, c_val, sense, rhs, name ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1205,7 +2490,7 @@ CAMLprim value gu_add_q_constr(
     constr_name = String_val( v_constr_name );
   }
 
-  int error = GRBaddqconstr( model,
+  int error = GU_TIMED( NULL, GRBaddqconstr( model,
 			     l_num_nz,
 			     l_ind,
 			     l_val,
@@ -1215,7 +2500,7 @@ CAMLprim value gu_add_q_constr(
 			     q_val,
 			     sense,
 			     rhs,
-			     constr_name );
+			     constr_name ) );
 			     
   CAMLreturn( Val_int( error ) );
 
@@ -1259,7 +2544,7 @@ CAMLprim value gu_add_sos(
   int* ind = get_i32a( v_ind, num_members );
   double* weight = get_fa( v_weight, num_members );
 
-  int error = GRBaddsos(model, num_sos, num_members, types, beg, ind, weight);
+  int error = GU_TIMED( NULL, GRBaddsos(model, num_sos, num_members, types, beg, ind, weight) );
   CAMLreturn( Val_int( error ) );
 
 }
@@ -1302,7 +2587,7 @@ CAMLprim value gu_add_gen_constr_min(
   int* vars = get_i32a( v_vars, n_vars );
   double constant = Double_val(v_constant);
 
-  int error = GRBaddgenconstrMin( model, name, res_var, n_vars, vars, constant );
+  int error = GU_TIMED( NULL, GRBaddgenconstrMin( model, name, res_var, n_vars, vars, constant ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1343,7 +2628,7 @@ CAMLprim value gu_add_gen_constr_max(
   int* vars = get_i32a( v_vars, n_vars );
   double constant = Double_val(v_constant);
 
-  int error = GRBaddgenconstrMax( model, name, res_var, n_vars, vars, constant );
+  int error = GU_TIMED( NULL, GRBaddgenconstrMax( model, name, res_var, n_vars, vars, constant ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1381,7 +2666,7 @@ CAMLprim value gu_add_gen_constr_and(
   int n_vars = Int_val( v_n_vars );
   int* vars = get_i32a( v_vars, n_vars );
 
-  int error = GRBaddgenconstrAnd( model, name, res_var, n_vars, vars );
+  int error = GU_TIMED( NULL, GRBaddgenconstrAnd( model, name, res_var, n_vars, vars ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1406,7 +2691,7 @@ CAMLprim value gu_add_gen_constr_or(
   int n_vars = Int_val( v_n_vars );
   int* vars = get_i32a( v_vars, n_vars );
 
-  int error = GRBaddgenconstrOr( model, name, res_var, n_vars, vars );
+  int error = GU_TIMED( NULL, GRBaddgenconstrOr( model, name, res_var, n_vars, vars ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1448,7 +2733,7 @@ CAMLprim value gu_add_gen_constr_indicator(
   char sense = Int_val( v_sense );
   double rhs = Double_val( v_rhs );
 
-  int error = GRBaddgenconstrIndicator( model, name, bin_var, bin_val, n_vars, ind, val, sense, rhs );
+  int error = GU_TIMED( NULL, GRBaddgenconstrIndicator( model, name, bin_var, bin_val, n_vars, ind, val, sense, rhs ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1494,7 +2779,7 @@ CAMLprim value gu_add_gen_constr_pwl(
   double* x_pts = get_fa(v_x_pts, n_pts);
   double* y_pts = get_fa(v_y_pts, n_pts);
 
-  int error = GRBaddgenconstrPWL( model, name, x_var, y_var, n_pts, x_pts, y_pts );
+  int error = GU_TIMED( NULL, GRBaddgenconstrPWL( model, name, x_var, y_var, n_pts, x_pts, y_pts ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1538,7 +2823,7 @@ CAMLprim value gu_add_gen_constr_exp(
     options = String_val( v_options );
   }
 
-  int error = GRBaddgenconstrExp( model, name, x_var, y_var, options );
+  int error = GU_TIMED( NULL, GRBaddgenconstrExp( model, name, x_var, y_var, options ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1570,7 +2855,7 @@ CAMLprim value gu_add_gen_constr_pow(
     options = String_val( v_options );
   }
 
-  int error = GRBaddgenconstrPow( model, name, x_var, y_var, a, options );
+  int error = GU_TIMED( NULL, GRBaddgenconstrPow( model, name, x_var, y_var, a, options ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1599,7 +2884,7 @@ CAMLprim value gu_del_gen_constrs(
   int num_del = Int_val( v_num_del );
   int* ind = get_i32a( v_ind, num_del );
 
-  int error = GRBdelgenconstrs(model, num_del, ind);
+  int error = GU_TIMED( NULL, GRBdelgenconstrs(model, num_del, ind) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1646,13 +2931,19 @@ CAMLprim value gu_feas_relax(
     feas_obf_p = get_fa( v_feas_obf_p, min_relax );
   }
 
-  int error = GRBfeasrelax( model,
+  // the penalty arrays are bigarrays, whose data lives outside of the
+  // OCaml heap, and are kept alive by the registered roots above
+  hold( model_block(v_model) );
+  caml_enter_blocking_section();
+  int error = GU_TIMED( NULL, GRBfeasrelax( model,
     relax_obj_type,
     min_relax, lb_pen,
     ub_pen,
     rhs_pen,
     feas_obf_p 
-  );
+  ) );
+  caml_leave_blocking_section();
+  unhold( model_block(v_model) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1713,7 +3004,7 @@ CAMLprim value gu_add_var(
     var_name = String_val( v_var_name );
   }
 
-  int error = GRBaddvar( model,
+  int error = GU_TIMED( NULL, GRBaddvar( model,
 			  num_nz,
 			  v_ind,
 			  v_val,
@@ -1721,7 +3012,7 @@ CAMLprim value gu_add_var(
 			  lb,
 			  ub,
 			  v_type,
-        var_name);
+        var_name) );
 
   CAMLreturn( Val_int( error ) );
 
@@ -1743,7 +3034,7 @@ CAMLprim value gu_add_var_bc(value* v_args, int arg_n )
         );
 }
 
-CAMLprim value gu_add_vars(
+static value add_vars(
  value v_model,
  value v_num_vars,
  value v_compressed_opt,
@@ -1751,7 +3042,8 @@ CAMLprim value gu_add_vars(
  value v_lower_bound_opt,
  value v_upper_bound_opt,
  value v_var_type_opt,
- value v_var_names_opt
+ value v_var_names_opt,
+ int packed_names
 )
 {
   CAMLparam5( v_model, v_num_vars, v_compressed_opt, v_obj_opt, v_lower_bound_opt );
@@ -1833,13 +3125,13 @@ CAMLprim value gu_add_vars(
   const char** var_names = NULL;
   if ( Is_some( v_var_names_opt ) ) {
     v_var_names = Some_val( v_var_names_opt );
-    var_names = get_sa( v_var_names, num_vars );
+    var_names = get_names( v_var_names, num_vars, packed_names );
     if ( var_names == NULL ) {
       caml_invalid_argument( "add_vars:var_names" );
     }
   }
 
-  int error = GRBaddvars( model,
+  int error = GU_TIMED( NULL, GRBaddvars( model,
 			  num_vars,
 			  num_nz,
 			  v_beg,
@@ -1849,11 +3141,9 @@ CAMLprim value gu_add_vars(
 			  lower_bound,
 			  upper_bound,
 			  (char*)var_type,
-			  (char**)var_names );
+			  (char**)var_names ) );
 
-  if ( Is_some( v_var_names ) ) {
-    free( var_names );
-  }
+  free( var_names );
 
   CAMLreturn( Val_int( error ) );
 
@@ -1884,7 +3174,7 @@ CAMLprim value gu_chg_coeffs(
     caml_invalid_argument( "chg_coeffs:val" );
   }
 
-  int error = GRBchgcoeffs( model, num_chgs, c_ind, v_ind, val );
+  int error = GU_TIMED( NULL, GRBchgcoeffs( model, num_chgs, c_ind, v_ind, val ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -1913,10 +3203,34 @@ CAMLprim value gu_add_q_p_terms(
     caml_invalid_argument( "add_q_p_terms:qval" );
   }
 
-  int error = GRBaddqpterms( model, num_qnz, q_row, q_col, q_val );
+  int error = GU_TIMED( NULL, GRBaddqpterms( model, num_qnz, q_row, q_col, q_val ) );
   CAMLreturn( Val_int( error ) );
 }
 
+CAMLprim value gu_add_vars(
+ value v_model,
+ value v_num_vars,
+ value v_compressed_opt,
+ value v_obj_opt,
+ value v_lower_bound_opt,
+ value v_upper_bound_opt,
+ value v_var_type_opt,
+ value v_var_names_opt
+)
+{
+  return add_vars(
+		      v_model,
+		      v_num_vars,
+		      v_compressed_opt,
+		      v_obj_opt,
+		      v_lower_bound_opt,
+		      v_upper_bound_opt,
+		      v_var_type_opt,
+		      v_var_names_opt,
+		      0
+		      );
+}
+
 CAMLprim value gu_add_vars_bc(value* v_args, int arg_n )
 {
   assert( arg_n == 8 );
@@ -1932,59 +3246,1652 @@ CAMLprim value gu_add_vars_bc(value* v_args, int arg_n )
         );
 }
 
-CAMLprim value gu_optimize( value v_model )
+CAMLprim value gu_add_vars_packed(
+ value v_model,
+ value v_num_vars,
+ value v_compressed_opt,
+ value v_obj_opt,
+ value v_lower_bound_opt,
+ value v_upper_bound_opt,
+ value v_var_type_opt,
+ value v_var_names_opt
+)
 {
-  CAMLparam1( v_model );
-  GRBmodel* model = model_val( v_model );
-  int error = GRBoptimize( model );
-  CAMLreturn( Val_int( error ) );
+  return add_vars(
+		      v_model,
+		      v_num_vars,
+		      v_compressed_opt,
+		      v_obj_opt,
+		      v_lower_bound_opt,
+		      v_upper_bound_opt,
+		      v_var_type_opt,
+		      v_var_names_opt,
+		      1
+		      );
 }
 
-CAMLprim value gu_write( value v_model, value v_path )
+CAMLprim value gu_add_vars_packed_bc(value* v_args, int arg_n )
 {
-  CAMLparam2( v_model, v_path );
-  GRBmodel* model = model_val( v_model );
-  const char* path = String_val( v_path );
-  int error = GRBwrite( model, path );
-  CAMLreturn( Val_int( error ) );
+  assert( arg_n == 8 );
+  return gu_add_vars_packed(
+		      v_args[0],
+		      v_args[1],
+		      v_args[2],
+		      v_args[3],
+		      v_args[4],
+		      v_args[5],
+		      v_args[6],
+		      v_args[7]
+		      );
 }
 
-CAMLprim value gu_compute_iis( value v_model )
+// model construction with 64-bit nonzero counts and begin offsets,
+// through the GRBX variants. OCaml int64 bigarrays are passed to
+// Gurobi as size_t arrays.
+
+_Static_assert( sizeof(size_t) == sizeof(int64_t), "size_t must be 64 bits" );
+
+// the num_nz, beg, ind and val fields of a compressed64 record, where
+// beg has at least num_beg elements
+static int get_compressed64(
+  value v_compressed,
+  long num_beg,
+  size_t* num_nz,
+  size_t** beg,
+  int** ind,
+  double** val
+)
 {
-  CAMLparam1( v_model );
-  GRBmodel* model = model_val( v_model );
-  int error = GRBcomputeIIS( model );
-  CAMLreturn( Val_int( error ) );
+  long n = Long_val( Field( v_compressed, 0 ) );
+  if ( n < 0 ) {
+    return 0;
+  }
+  *num_nz = n;
+  *beg = get_ba_range( Field( v_compressed, 1 ), CAML_BA_INT64, 0, num_beg );
+  *ind = get_ba_range( Field( v_compressed, 2 ), CAML_BA_INT32, 0, n );
+  *val = get_ba_range( Field( v_compressed, 3 ), CAML_BA_FLOAT64, 0, n );
+  return *beg != NULL && *ind != NULL && *val != NULL;
 }
 
-CAMLprim value gu_set_objective_n(
-  value v_model,
-  value v_index,
-  value	v_priority,
-  value v_weight,
-  value	v_abstol,
-  value v_reltol,
-  value v_name_opt,
-  value v_constant,
-  value	v_nnz,
-  value	v_ind,
-  value	v_val
+// whether the num_beg begin offsets of beg are nondecreasing and
+// within the num_nz nonzeros; negative int64 offsets are huge as
+// size_t, so they are caught as well
+static int beg64_ok( const size_t* beg, long num_beg, size_t num_nz )
+{
+  for ( long i = 0; i < num_beg; i++ ) {
+    size_t end = i + 1 < num_beg ? beg[i + 1] : num_nz;
+    if ( beg[i] > end || end > num_nz ) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+CAMLprim value gu_add_constrs64(
+ value v_model,
+ value v_num_constraints,
+ value v_compressed_opt,
+ value v_sense,
+ value v_rhs,
+ value v_constr_names_opt
 )
 {
-  CAMLparam5( v_model, v_index, v_priority, v_weight, v_abstol );
-  CAMLxparam5( v_reltol, v_name_opt, v_constant, v_nnz, v_ind );
-  CAMLxparam1( v_val );
-  CAMLlocal1( v_name );
+  CAMLparam5( v_model, v_num_constraints, v_compressed_opt, v_sense, v_rhs );
+  CAMLxparam1( v_constr_names_opt );
 
   GRBmodel* model = model_val( v_model );
-  int index = Int_val( v_index );
-  int priority = Int_val( v_priority );
-  double weight = Double_val( v_weight );
-  double abstol = Double_val( v_abstol );
-  double reltol = Double_val( v_reltol );
+  int num_constraints = Int_val( v_num_constraints );
 
-  // name, optional
-  const char* name = NULL;
+  size_t num_nz = 0;
+  size_t* c_beg = NULL;
+  int* c_ind = NULL;
+  double* c_val = NULL;
+
+  if ( Is_some( v_compressed_opt ) ) {
+    if ( ! get_compressed64( Some_val( v_compressed_opt ), num_constraints,
+                             &num_nz, &c_beg, &c_ind, &c_val ) ) {
+      caml_invalid_argument( "add_constrs64:compressed" );
+    }
+    if ( ! beg64_ok( c_beg, num_constraints, num_nz ) ) {
+      caml_invalid_argument( "add_constrs64:compressed.beg" );
+    }
+  }
+
+  char* sense = get_ca( v_sense, num_constraints );
+  if ( sense == NULL ) {
+    caml_invalid_argument( "add_constrs64:sense" );
+  }
+  double* rhs = get_fa( v_rhs, num_constraints );
+  if ( rhs == NULL ) {
+    caml_invalid_argument( "add_constrs64:rhs" );
+  }
+
+  const char** constr_names = NULL;
+  if ( Is_some( v_constr_names_opt ) ) {
+    constr_names = get_sa( Some_val( v_constr_names_opt ), num_constraints );
+    if ( constr_names == NULL ) {
+      caml_invalid_argument( "add_constrs64:constr_names" );
+    }
+  }
+
+  int error = GU_TIMED( NULL, GRBXaddconstrs( model,
+			      num_constraints,
+			      num_nz,
+			      c_beg,
+			      c_ind,
+			      c_val,
+			      sense,
+			      rhs,
+			      (char**)constr_names
+			    ) );
+  free( constr_names );
+
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_add_constrs64_bc(value* v_args, int arg_n )
+{
+  assert( arg_n == 6 );
+  return gu_add_constrs64(
+			  v_args[0],
+			  v_args[1],
+			  v_args[2],
+			  v_args[3],
+			  v_args[4],
+			  v_args[5]
+			  );
+}
+
+CAMLprim value gu_add_vars64(
+ value v_model,
+ value v_num_vars,
+ value v_compressed_opt,
+ value v_obj_opt,
+ value v_lower_bound_opt,
+ value v_upper_bound_opt,
+ value v_var_type_opt,
+ value v_var_names_opt
+)
+{
+  CAMLparam5( v_model, v_num_vars, v_compressed_opt, v_obj_opt, v_lower_bound_opt );
+  CAMLxparam3( v_upper_bound_opt, v_var_type_opt, v_var_names_opt );
+
+  GRBmodel* model = model_val( v_model );
+  int num_vars = Int_val( v_num_vars );
+
+  size_t num_nz = 0;
+  size_t* v_beg = NULL;
+  int* v_ind = NULL;
+  double* v_val = NULL;
+
+  if ( Is_some( v_compressed_opt ) ) {
+    if ( ! get_compressed64( Some_val( v_compressed_opt ), num_vars,
+                             &num_nz, &v_beg, &v_ind, &v_val ) ) {
+      caml_invalid_argument( "add_vars64:compressed" );
+    }
+    if ( ! beg64_ok( v_beg, num_vars, num_nz ) ) {
+      caml_invalid_argument( "add_vars64:compressed.beg" );
+    }
+  }
+
+  double* obj = NULL;
+  if ( Is_some( v_obj_opt ) ) {
+    obj = get_fa( Some_val( v_obj_opt ), num_vars );
+    if ( obj == NULL ) {
+      caml_invalid_argument( "add_vars64:objective" );
+    }
+  }
+
+  double* lower_bound = NULL;
+  if ( Is_some( v_lower_bound_opt ) ) {
+    lower_bound = get_fa( Some_val( v_lower_bound_opt ), num_vars );
+    if ( lower_bound == NULL ) {
+      caml_invalid_argument( "add_vars64:lower_bound" );
+    }
+  }
+
+  double* upper_bound = NULL;
+  if ( Is_some( v_upper_bound_opt ) ) {
+    upper_bound = get_fa( Some_val( v_upper_bound_opt ), num_vars );
+    if ( upper_bound == NULL ) {
+      caml_invalid_argument( "add_vars64:upper_bound" );
+    }
+  }
+
+  char* var_type = NULL;
+  if ( Is_some( v_var_type_opt ) ) {
+    var_type = get_ca( Some_val( v_var_type_opt ), num_vars );
+    if ( var_type == NULL ) {
+      caml_invalid_argument( "add_vars64:var_type" );
+    }
+  }
+
+  const char** var_names = NULL;
+  if ( Is_some( v_var_names_opt ) ) {
+    var_names = get_sa( Some_val( v_var_names_opt ), num_vars );
+    if ( var_names == NULL ) {
+      caml_invalid_argument( "add_vars64:var_names" );
+    }
+  }
+
+  int error = GU_TIMED( NULL, GRBXaddvars( model,
+			   num_vars,
+			   num_nz,
+			   v_beg,
+			   v_ind,
+			   v_val,
+			   obj,
+			   lower_bound,
+			   upper_bound,
+			   var_type,
+			   (char**)var_names ) );
+  free( var_names );
+
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_add_vars64_bc(value* v_args, int arg_n )
+{
+  assert( arg_n == 8 );
+  return gu_add_vars64(
+		       v_args[0],
+		       v_args[1],
+		       v_args[2],
+		       v_args[3],
+		       v_args[4],
+		       v_args[5],
+		       v_args[6],
+		       v_args[7]
+		       );
+}
+
+CAMLprim value gu_chg_coeffs64(
+ value v_model,
+ value v_num_chgs,
+ value v_c_ind,
+ value v_v_ind,
+ value v_val
+)
+{
+  CAMLparam5( v_model, v_num_chgs, v_c_ind, v_v_ind, v_val );
+
+  GRBmodel* model = model_val( v_model );
+  long num_chgs = Long_val( v_num_chgs );
+  int* c_ind = get_ba_range( v_c_ind, CAML_BA_INT32, 0, num_chgs );
+  if ( c_ind == NULL ) {
+    caml_invalid_argument( "chg_coeffs64:cind" );
+  }
+  int* v_ind = get_ba_range( v_v_ind, CAML_BA_INT32, 0, num_chgs );
+  if ( v_ind == NULL ) {
+    caml_invalid_argument( "chg_coeffs64:vind" );
+  }
+  double* val = get_ba_range( v_val, CAML_BA_FLOAT64, 0, num_chgs );
+  if ( val == NULL ) {
+    caml_invalid_argument( "chg_coeffs64:val" );
+  }
+
+  int error = GU_TIMED( NULL, GRBXchgcoeffs( model, num_chgs, c_ind, v_ind, val ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+// create a model in one call, from a CSC matrix with 64-bit begin
+// offsets; the column lengths Gurobi wants are derived from them
+CAMLprim value gu_load_model(
+ value v_env,
+ value v_name_opt,
+ value v_num_vars,
+ value v_num_constrs,
+ value v_obj_sense,
+ value v_obj_con,
+ value v_objective_opt,
+ value v_sense,
+ value v_rhs,
+ value v_matrix,
+ value v_lower_bound_opt,
+ value v_upper_bound_opt,
+ value v_var_type_opt,
+ value v_var_names_opt,
+ value v_constr_names_opt
+)
+{
+  CAMLparam5( v_env, v_name_opt, v_num_vars, v_num_constrs, v_obj_sense );
+  CAMLxparam5( v_obj_con, v_objective_opt, v_sense, v_rhs, v_matrix );
+  CAMLxparam5( v_lower_bound_opt, v_upper_bound_opt, v_var_type_opt, v_var_names_opt, v_constr_names_opt );
+  CAMLlocal2( v_model, v_res );
+
+  GRBenv* env = env_val( v_env );
+  const char* name = Is_some( v_name_opt ) ? String_val( Some_val( v_name_opt ) ) : NULL;
+  int num_vars = Int_val( v_num_vars );
+  int num_constrs = Int_val( v_num_constrs );
+  if ( num_vars < 0 || num_constrs < 0 ) {
+    caml_invalid_argument( "load_model:(num_vars,num_constrs)" );
+  }
+
+  double* objective = NULL;
+  if ( Is_some( v_objective_opt ) ) {
+    objective = get_fa( Some_val( v_objective_opt ), num_vars );
+    if ( objective == NULL ) {
+      caml_invalid_argument( "load_model:objective" );
+    }
+  }
+
+  char* sense = get_ca( v_sense, num_constrs );
+  if ( sense == NULL ) {
+    caml_invalid_argument( "load_model:sense" );
+  }
+  double* rhs = get_fa( v_rhs, num_constrs );
+  if ( rhs == NULL ) {
+    caml_invalid_argument( "load_model:rhs" );
+  }
+
+  size_t num_nz;
+  size_t* v_beg;
+  int* v_ind;
+  double* v_val;
+  if ( ! get_compressed64( v_matrix, num_vars, &num_nz, &v_beg, &v_ind, &v_val ) ) {
+    caml_invalid_argument( "load_model:matrix" );
+  }
+
+  double* lower_bound = NULL;
+  if ( Is_some( v_lower_bound_opt ) ) {
+    lower_bound = get_fa( Some_val( v_lower_bound_opt ), num_vars );
+    if ( lower_bound == NULL ) {
+      caml_invalid_argument( "load_model:lower_bound" );
+    }
+  }
+
+  double* upper_bound = NULL;
+  if ( Is_some( v_upper_bound_opt ) ) {
+    upper_bound = get_fa( Some_val( v_upper_bound_opt ), num_vars );
+    if ( upper_bound == NULL ) {
+      caml_invalid_argument( "load_model:upper_bound" );
+    }
+  }
+
+  char* var_type = NULL;
+  if ( Is_some( v_var_type_opt ) ) {
+    var_type = get_ca( Some_val( v_var_type_opt ), num_vars );
+    if ( var_type == NULL ) {
+      caml_invalid_argument( "load_model:var_type" );
+    }
+  }
+
+  // column lengths, checking that the begin offsets are nondecreasing
+  // and within the nonzeros
+  int* v_len = malloc( sizeof(int) * (num_vars > 0 ? num_vars : 1) );
+  if ( v_len == NULL ) {
+    caml_raise_out_of_memory();
+  }
+  for ( int j = 0; j < num_vars; j++ ) {
+    size_t end = j + 1 < num_vars ? v_beg[j + 1] : num_nz;
+    if ( v_beg[j] > end || end > num_nz || end - v_beg[j] > INT_MAX ) {
+      free( v_len );
+      caml_invalid_argument( "load_model:matrix.beg" );
+    }
+    v_len[j] = end - v_beg[j];
+  }
+
+  const char** var_names = NULL;
+  if ( Is_some( v_var_names_opt ) ) {
+    var_names = get_names( Some_val( v_var_names_opt ), num_vars, 1 );
+    if ( var_names == NULL ) {
+      free( v_len );
+      caml_invalid_argument( "load_model:var_names" );
+    }
+  }
+
+  const char** constr_names = NULL;
+  if ( Is_some( v_constr_names_opt ) ) {
+    constr_names = get_names( Some_val( v_constr_names_opt ), num_constrs, 1 );
+    if ( constr_names == NULL ) {
+      free( v_len );
+      free( var_names );
+      caml_invalid_argument( "load_model:constr_names" );
+    }
+  }
+
+  GRBmodel* model = NULL;
+  int error = GU_TIMED( NULL, GRBXloadmodel( env,
+			     &model,
+			     name,
+			     num_vars,
+			     num_constrs,
+			     Int_val( v_obj_sense ),
+			     Double_val( v_obj_con ),
+			     objective,
+			     sense,
+			     rhs,
+			     v_beg,
+			     v_len,
+			     v_ind,
+			     v_val,
+			     lower_bound,
+			     upper_bound,
+			     var_type,
+			     (char**)var_names,
+			     (char**)constr_names ) );
+  free( v_len );
+  free( var_names );
+  free( constr_names );
+
+  if ( error == 0 ) {
+    // the model may inherit the log callback of its environment
+    v_model = alloc_model( model, v_env, env_block(v_env)->log_buffer );
+
+    // Ok model
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, v_model );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+CAMLprim value gu_load_model_bc(value* v_args, int arg_n )
+{
+  assert( arg_n == 15 );
+  return gu_load_model(
+		       v_args[0],
+		       v_args[1],
+		       v_args[2],
+		       v_args[3],
+		       v_args[4],
+		       v_args[5],
+		       v_args[6],
+		       v_args[7],
+		       v_args[8],
+		       v_args[9],
+		       v_args[10],
+		       v_args[11],
+		       v_args[12],
+		       v_args[13],
+		       v_args[14]
+		       );
+}
+
+// read the constraint matrix back, by rows (constraints) or by columns
+// (variables), for the range [start, start + len). The number of
+// nonzeros is queried first, so that the caller can size the
+// destination; the fill then writes straight into its bigarrays.
+
+static value matrix_result( int error, long num_nz )
+{
+  CAMLparam0();
+  CAMLlocal1( v_res );
+  if ( error == 0 ) {
+    // Ok num_nz
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, Val_long(num_nz) );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+static value matrix_nz( value v_model, value v_start, value v_len, int by_rows )
+{
+  CAMLparam3( v_model, v_start, v_len );
+  GRBmodel* model = model_val( v_model );
+  int start = Int_val( v_start );
+  int len = Int_val( v_len );
+  if ( start < 0 || len < 0 ) {
+    caml_invalid_argument( by_rows ? "get_constrs_nz:(start,len)" : "get_vars_nz:(start,len)" );
+  }
+  size_t num_nz = 0;
+  int error = GU_TIMED( NULL, by_rows
+    ? GRBXgetconstrs( model, &num_nz, NULL, NULL, NULL, start, len )
+    : GRBXgetvars( model, &num_nz, NULL, NULL, NULL, start, len ) );
+  CAMLreturn( matrix_result( error, num_nz ) );
+}
+
+CAMLprim value gu_get_constrs_nz( value v_model, value v_start, value v_len )
+{
+  return matrix_nz( v_model, v_start, v_len, 1 );
+}
+
+CAMLprim value gu_get_vars_nz( value v_model, value v_start, value v_len )
+{
+  return matrix_nz( v_model, v_start, v_len, 0 );
+}
+
+// fill a compressed (wide = 0) or compressed64 (wide = 1) destination,
+// whose num_nz field bounds the nonzeros that may be written
+static value matrix_fill( value v_model, value v_start, value v_len, value v_dst, int by_rows, int wide )
+{
+  CAMLparam4( v_model, v_start, v_len, v_dst );
+  GRBmodel* model = model_val( v_model );
+  int start = Int_val( v_start );
+  int len = Int_val( v_len );
+  long capacity = Long_val( Field( v_dst, 0 ) );
+  void* beg = get_ba_range( Field( v_dst, 1 ), wide ? CAML_BA_INT64 : CAML_BA_INT32, 0, len );
+  int* ind = get_ba_range( Field( v_dst, 2 ), CAML_BA_INT32, 0, capacity );
+  double* val = get_ba_range( Field( v_dst, 3 ), CAML_BA_FLOAT64, 0, capacity );
+  if ( start < 0 || len < 0 || beg == NULL || ind == NULL || val == NULL ) {
+    caml_invalid_argument( by_rows ? "get_constrs:dst" : "get_vars:dst" );
+  }
+
+  // check the capacity first, as Gurobi does not
+  size_t num_nz = 0;
+  int error = GU_TIMED( NULL, by_rows
+    ? GRBXgetconstrs( model, &num_nz, NULL, NULL, NULL, start, len )
+    : GRBXgetvars( model, &num_nz, NULL, NULL, NULL, start, len ) );
+  if ( error == 0 && num_nz > (size_t)capacity ) {
+    caml_invalid_argument( by_rows ? "get_constrs:dst.num_nz" : "get_vars:dst.num_nz" );
+  }
+  if ( error == 0 && ! wide && num_nz > INT_MAX ) {
+    caml_invalid_argument( by_rows ? "get_constrs:use get_constrs64" : "get_vars:use get_vars64" );
+  }
+
+  if ( error == 0 ) {
+    // bigarray data does not move, so the runtime can carry on
+    hold( model_block(v_model) );
+    caml_enter_blocking_section();
+    if ( wide ) {
+      error = GU_TIMED( NULL, by_rows
+        ? GRBXgetconstrs( model, &num_nz, beg, ind, val, start, len )
+        : GRBXgetvars( model, &num_nz, beg, ind, val, start, len ) );
+    }
+    else {
+      int nz = 0;
+      error = GU_TIMED( NULL, by_rows
+        ? GRBgetconstrs( model, &nz, beg, ind, val, start, len )
+        : GRBgetvars( model, &nz, beg, ind, val, start, len ) );
+      num_nz = nz;
+    }
+    caml_leave_blocking_section();
+    unhold( model_block(v_model) );
+  }
+  CAMLreturn( matrix_result( error, num_nz ) );
+}
+
+CAMLprim value gu_get_constrs( value v_model, value v_start, value v_len, value v_dst )
+{
+  return matrix_fill( v_model, v_start, v_len, v_dst, 1, 0 );
+}
+
+CAMLprim value gu_get_constrs64( value v_model, value v_start, value v_len, value v_dst )
+{
+  return matrix_fill( v_model, v_start, v_len, v_dst, 1, 1 );
+}
+
+CAMLprim value gu_get_vars( value v_model, value v_start, value v_len, value v_dst )
+{
+  return matrix_fill( v_model, v_start, v_len, v_dst, 0, 0 );
+}
+
+CAMLprim value gu_get_vars64( value v_model, value v_start, value v_len, value v_dst )
+{
+  return matrix_fill( v_model, v_start, v_len, v_dst, 0, 1 );
+}
+
+CAMLprim value gu_get_coeff( value v_model, value v_constr, value v_var )
+{
+  CAMLparam3( v_model, v_constr, v_var );
+  CAMLlocal2( v_res, v_d );
+  GRBmodel* model = model_val( v_model );
+  double d;
+  int error = GU_TIMED( NULL, GRBgetcoeff( model, Int_val( v_constr ), Int_val( v_var ), &d ) );
+  if ( error == 0 ) {
+    // Ok d
+    v_d = caml_copy_double(d);
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, v_d );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+// serialization of models, for Marshal. A model is written as its
+// linear part (matrix by columns, objective, bounds, types, senses,
+// right-hand sides, names) and its non-default parameters, and is
+// read back with GRBXloadmodel into the environment set with
+// set_deserialization_env. Models with other parts are not
+// supported. The serialize function must not raise, which would
+// leave Marshal's state behind, so a model that cannot be
+// serialized is written as GU_MODEL_ERROR and its error code, and
+// fails to deserialize; marshal_check reports this beforehand.
+
+#define GU_MODEL_FORMAT 2
+#define GU_MODEL_ERROR 0
+
+// the environment deserialized models are created in; a generational
+// global root, Val_unit if unset
+static value gu_deserialization_env = Val_unit;
+
+CAMLprim value gu_set_deserialization_env( value v_env )
+{
+  CAMLparam1( v_env );
+  if ( gu_deserialization_env == Val_unit ) {
+    gu_deserialization_env = v_env;
+    caml_register_generational_global_root( &gu_deserialization_env );
+  }
+  else {
+    caml_modify_generational_global_root( &gu_deserialization_env, v_env );
+  }
+  CAMLreturn( Val_unit );
+}
+
+CAMLprim value gu_register_model_ops( value unit )
+{
+  CAMLparam1( unit /* unused */ );
+  caml_register_custom_operations( &model_ops );
+  CAMLreturn( Val_unit );
+}
+
+static void serialize_string( const char* s )
+{
+  size_t len = strlen( s );
+  caml_serialize_int_8( len );
+  caml_serialize_block_1( (void*)s, len );
+}
+
+// a malloc'd copy of a string written by serialize_string, or NULL if
+// it cannot be allocated, in which case it is skipped
+static char* deserialize_string( void )
+{
+  size_t len = caml_deserialize_uint_8();
+  char* s = malloc( len + 1 );
+  if ( s != NULL ) {
+    caml_deserialize_block_1( s, len );
+    s[len] = '\0';
+  }
+  else {
+    char skip[256];
+    for ( size_t n = 0; n < len; n += sizeof(skip) ) {
+      caml_deserialize_block_1( skip, len - n < sizeof(skip) ? len - n : sizeof(skip) );
+    }
+  }
+  return s;
+}
+
+// GRB_ERROR_NOT_SUPPORTED if model has parts that serialization
+// would lose: quadratic terms or constraints, SOS or general
+// constraints
+static int model_marshal_check( GRBmodel* model )
+{
+  static const char* const parts[] = {
+    GRB_INT_ATTR_NUMQNZS,
+    GRB_INT_ATTR_NUMQCONSTRS,
+    GRB_INT_ATTR_NUMSOS,
+    GRB_INT_ATTR_NUMGENCONSTRS
+  };
+  if ( model == NULL ) {
+    return GRB_ERROR_NULL_ARGUMENT;
+  }
+  int error = GU_TIMED( NULL, GRBupdatemodel( model ) );
+  for ( size_t k = 0; error == 0 && k < sizeof(parts) / sizeof(parts[0]); k++ ) {
+    int n = 0;
+    error = GU_TIMED( parts[k], GRBgetintattr( model, parts[k], &n ) );
+    if ( error == 0 && n > 0 ) {
+      error = GRB_ERROR_NOT_SUPPORTED;
+    }
+  }
+  return error;
+}
+
+CAMLprim value gu_marshal_check( value v_model )
+{
+  CAMLparam1( v_model );
+  CAMLreturn( Val_int( model_marshal_check( model_val( v_model ) ) ) );
+}
+
+// a parameter whose value differs from its default
+struct gu_param {
+  const char* name; // owned by the environment
+  int type;         // 1: int, 2: double, 3: string, as GRBgetparamtype
+  int i;
+  double d;
+  char s[GRB_MAX_STRLEN];
+};
+
+// the non-default parameters of env, as a malloc'd array of *num
+// elements; they are enumerated in memory, rather than written to a
+// file with GRBwriteparams
+static struct gu_param* non_default_params( GRBenv* env, int* num, int* error )
+{
+  *num = 0;
+  *error = 0;
+  int num_params = GRBgetnumparams( env );
+  struct gu_param* params = malloc( sizeof(struct gu_param) * (num_params > 0 ? num_params : 1) );
+  if ( params == NULL ) {
+    *error = GRB_ERROR_OUT_OF_MEMORY;
+    return NULL;
+  }
+  for ( int k = 0; k < num_params && *error == 0; k++ ) {
+    char* name = NULL;
+    *error = GU_TIMED( NULL, GRBgetparamname( env, k, &name ) );
+    if ( *error != 0 ) {
+      break;
+    }
+    struct gu_param* p = &params[*num];
+    p->name = name;
+    p->type = GRBgetparamtype( env, name );
+    int is_default = 1;
+    if ( p->type == 1 ) {
+      int min, max, def;
+      *error = GU_TIMED( name, GRBgetintparaminfo( env, name, &p->i, &min, &max, &def ) );
+      is_default = p->i == def;
+    }
+    else if ( p->type == 2 ) {
+      double min, max, def;
+      *error = GU_TIMED( name, GRBgetdblparaminfo( env, name, &p->d, &min, &max, &def ) );
+      is_default = p->d == def;
+    }
+    else if ( p->type == 3 ) {
+      char def[GRB_MAX_STRLEN];
+      *error = GU_TIMED( name, GRBgetstrparaminfo( env, name, p->s, def ) );
+      is_default = strcmp( p->s, def ) == 0;
+    }
+    if ( *error == 0 && !is_default ) {
+      (*num)++;
+    }
+  }
+  return params;
+}
+
+static void serialize_params( const struct gu_param* params, int num )
+{
+  caml_serialize_int_4( num );
+  for ( int k = 0; k < num; k++ ) {
+    serialize_string( params[k].name );
+    caml_serialize_int_1( params[k].type );
+    switch ( params[k].type ) {
+    case 1: caml_serialize_int_8( params[k].i ); break;
+    case 2: caml_serialize_float_8( params[k].d ); break;
+    default: serialize_string( params[k].s ); break;
+    }
+  }
+}
+
+// read the parameters written by serialize_params, and set them in
+// env; all of them are read, even after an error
+static int deserialize_params( GRBenv* env )
+{
+  int error = 0;
+  int num = caml_deserialize_sint_4();
+  for ( int k = 0; k < num; k++ ) {
+    char* name = deserialize_string();
+    int type = caml_deserialize_uint_1();
+    int e;
+    if ( type == 1 ) {
+      int i = caml_deserialize_sint_8();
+      e = name == NULL ? GRB_ERROR_OUT_OF_MEMORY : GU_TIMED( name, GRBsetintparam( env, name, i ) );
+    }
+    else if ( type == 2 ) {
+      double d = caml_deserialize_float_8();
+      e = name == NULL ? GRB_ERROR_OUT_OF_MEMORY : GU_TIMED( name, GRBsetdblparam( env, name, d ) );
+    }
+    else {
+      char* str = deserialize_string();
+      e = name == NULL || str == NULL
+        ? GRB_ERROR_OUT_OF_MEMORY
+        : GU_TIMED( name, GRBsetstrparam( env, name, str ) );
+      free( str );
+    }
+    free( name );
+    if ( error == 0 ) {
+      error = e;
+    }
+  }
+  return error;
+}
+
+static void gu_model_serialize( value v_model, uintnat* bsize_32, uintnat* bsize_64 )
+{
+  // not model_val, which raises on a freed model
+  GRBmodel* model = model_block( v_model )->model;
+  int num_vars = 0, num_constrs = 0, obj_sense = 0;
+  double obj_con = 0.0;
+  size_t num_nz = 0;
+  char* model_name = NULL;
+  int num_params = 0;
+
+  *bsize_32 = sizeof(struct gu_model);
+  *bsize_64 = sizeof(struct gu_model);
+
+  int error = model_marshal_check( model );
+  if ( error == 0 ) error = GU_TIMED( GRB_INT_ATTR_NUMVARS, GRBgetintattr( model, GRB_INT_ATTR_NUMVARS, &num_vars ) );
+  if ( error == 0 ) error = GU_TIMED( GRB_INT_ATTR_NUMCONSTRS, GRBgetintattr( model, GRB_INT_ATTR_NUMCONSTRS, &num_constrs ) );
+  if ( error == 0 ) error = GU_TIMED( GRB_INT_ATTR_MODELSENSE, GRBgetintattr( model, GRB_INT_ATTR_MODELSENSE, &obj_sense ) );
+  if ( error == 0 ) error = GU_TIMED( GRB_DBL_ATTR_OBJCON, GRBgetdblattr( model, GRB_DBL_ATTR_OBJCON, &obj_con ) );
+  if ( error == 0 ) error = GU_TIMED( GRB_STR_ATTR_MODELNAME, GRBgetstrattr( model, GRB_STR_ATTR_MODELNAME, &model_name ) );
+  if ( error == 0 ) error = GU_TIMED( NULL, GRBXgetvars( model, &num_nz, NULL, NULL, NULL, 0, num_vars ) );
+  if ( error != 0 ) {
+    caml_serialize_int_4( GU_MODEL_ERROR );
+    caml_serialize_int_4( error );
+    return;
+  }
+
+  size_t nv = num_vars > 0 ? num_vars : 1;
+  size_t nc = num_constrs > 0 ? num_constrs : 1;
+  size_t nz = num_nz > 0 ? num_nz : 1;
+  size_t* beg = malloc( nv * sizeof(size_t) );
+  int* ind = malloc( nz * sizeof(int) );
+  double* val = malloc( nz * sizeof(double) );
+  double* obj = malloc( nv * sizeof(double) );
+  double* lb = malloc( nv * sizeof(double) );
+  double* ub = malloc( nv * sizeof(double) );
+  char* vtype = malloc( nv );
+  char* sense = malloc( nc );
+  double* rhs = malloc( nc * sizeof(double) );
+  char** var_names = malloc( nv * sizeof(char*) );
+  char** constr_names = malloc( nc * sizeof(char*) );
+  struct gu_param* params = NULL;
+
+  if ( beg == NULL || ind == NULL || val == NULL || obj == NULL || lb == NULL ||
+       ub == NULL || vtype == NULL || sense == NULL || rhs == NULL ||
+       var_names == NULL || constr_names == NULL ) {
+    error = GRB_ERROR_OUT_OF_MEMORY;
+  }
+  if ( error == 0 ) error = GU_TIMED( NULL, GRBXgetvars( model, &num_nz, beg, ind, val, 0, num_vars ) );
+  if ( num_vars > 0 ) {
+    if ( error == 0 ) error = GU_TIMED( GRB_DBL_ATTR_OBJ, GRBgetdblattrarray( model, GRB_DBL_ATTR_OBJ, 0, num_vars, obj ) );
+    if ( error == 0 ) error = GU_TIMED( GRB_DBL_ATTR_LB, GRBgetdblattrarray( model, GRB_DBL_ATTR_LB, 0, num_vars, lb ) );
+    if ( error == 0 ) error = GU_TIMED( GRB_DBL_ATTR_UB, GRBgetdblattrarray( model, GRB_DBL_ATTR_UB, 0, num_vars, ub ) );
+    if ( error == 0 ) error = GU_TIMED( GRB_CHAR_ATTR_VTYPE, GRBgetcharattrarray( model, GRB_CHAR_ATTR_VTYPE, 0, num_vars, vtype ) );
+    if ( error == 0 ) error = GU_TIMED( GRB_STR_ATTR_VARNAME, GRBgetstrattrarray( model, GRB_STR_ATTR_VARNAME, 0, num_vars, var_names ) );
+  }
+  if ( num_constrs > 0 ) {
+    if ( error == 0 ) error = GU_TIMED( GRB_CHAR_ATTR_SENSE, GRBgetcharattrarray( model, GRB_CHAR_ATTR_SENSE, 0, num_constrs, sense ) );
+    if ( error == 0 ) error = GU_TIMED( GRB_DBL_ATTR_RHS, GRBgetdblattrarray( model, GRB_DBL_ATTR_RHS, 0, num_constrs, rhs ) );
+    if ( error == 0 ) error = GU_TIMED( GRB_STR_ATTR_CONSTRNAME, GRBgetstrattrarray( model, GRB_STR_ATTR_CONSTRNAME, 0, num_constrs, constr_names ) );
+  }
+  if ( error == 0 ) {
+    params = non_default_params( GRBgetenv( model ), &num_params, &error );
+  }
+
+  if ( error == 0 ) {
+    caml_serialize_int_4( GU_MODEL_FORMAT );
+    caml_serialize_int_4( num_vars );
+    caml_serialize_int_4( num_constrs );
+    caml_serialize_int_8( num_nz );
+    caml_serialize_int_4( obj_sense );
+    caml_serialize_float_8( obj_con );
+    serialize_string( model_name != NULL ? model_name : "" );
+    caml_serialize_block_8( beg, num_vars );
+    caml_serialize_block_4( ind, num_nz );
+    caml_serialize_block_float_8( val, num_nz );
+    caml_serialize_block_float_8( obj, num_vars );
+    caml_serialize_block_float_8( lb, num_vars );
+    caml_serialize_block_float_8( ub, num_vars );
+    caml_serialize_block_1( vtype, num_vars );
+    caml_serialize_block_1( sense, num_constrs );
+    caml_serialize_block_float_8( rhs, num_constrs );
+    for ( int j = 0; j < num_vars; j++ ) {
+      serialize_string( var_names[j] );
+    }
+    for ( int i = 0; i < num_constrs; i++ ) {
+      serialize_string( constr_names[i] );
+    }
+    serialize_params( params, num_params );
+  }
+  else {
+    caml_serialize_int_4( GU_MODEL_ERROR );
+    caml_serialize_int_4( error );
+  }
+
+  free( beg );
+  free( ind );
+  free( val );
+  free( obj );
+  free( lb );
+  free( ub );
+  free( vtype );
+  free( sense );
+  free( rhs );
+  free( var_names );
+  free( constr_names );
+  free( params );
+}
+
+static uintnat gu_model_deserialize( void* dst )
+{
+  if ( gu_deserialization_env == Val_unit ) {
+    caml_deserialize_error( "gurobi.model: no deserialization environment" );
+  }
+  GRBenv* env = env_val( gu_deserialization_env );
+
+  uint32_t format = caml_deserialize_uint_4();
+  if ( format == GU_MODEL_ERROR ) {
+    char msg[80];
+    snprintf( msg, sizeof(msg), "gurobi.model: the model could not be marshaled (error %d)",
+              (int)caml_deserialize_sint_4() );
+    caml_deserialize_error( msg );
+  }
+  if ( format != GU_MODEL_FORMAT ) {
+    caml_deserialize_error( "gurobi.model: unknown format" );
+  }
+  int num_vars = caml_deserialize_sint_4();
+  int num_constrs = caml_deserialize_sint_4();
+  size_t num_nz = caml_deserialize_uint_8();
+  int obj_sense = caml_deserialize_sint_4();
+  double obj_con = caml_deserialize_float_8();
+
+  size_t nv = num_vars > 0 ? num_vars : 1;
+  size_t nc = num_constrs > 0 ? num_constrs : 1;
+  size_t nz = num_nz > 0 ? num_nz : 1;
+  char* model_name = deserialize_string();
+  size_t* beg = malloc( nv * sizeof(size_t) );
+  int* len = malloc( nv * sizeof(int) );
+  int* ind = malloc( nz * sizeof(int) );
+  double* val = malloc( nz * sizeof(double) );
+  double* obj = malloc( nv * sizeof(double) );
+  double* lb = malloc( nv * sizeof(double) );
+  double* ub = malloc( nv * sizeof(double) );
+  char* vtype = malloc( nv );
+  char* sense = malloc( nc );
+  double* rhs = malloc( nc * sizeof(double) );
+  char** var_names = calloc( nv, sizeof(char*) );
+  char** constr_names = calloc( nc, sizeof(char*) );
+  GRBmodel* model = NULL;
+  int error = 0;
+
+  if ( model_name == NULL || beg == NULL || len == NULL || ind == NULL ||
+       val == NULL || obj == NULL || lb == NULL || ub == NULL ||
+       vtype == NULL || sense == NULL || rhs == NULL || var_names == NULL ||
+       constr_names == NULL ) {
+    error = GRB_ERROR_OUT_OF_MEMORY;
+  }
+  else {
+    caml_deserialize_block_8( beg, num_vars );
+    caml_deserialize_block_4( ind, num_nz );
+    caml_deserialize_block_float_8( val, num_nz );
+    caml_deserialize_block_float_8( obj, num_vars );
+    caml_deserialize_block_float_8( lb, num_vars );
+    caml_deserialize_block_float_8( ub, num_vars );
+    caml_deserialize_block_1( vtype, num_vars );
+    caml_deserialize_block_1( sense, num_constrs );
+    caml_deserialize_block_float_8( rhs, num_constrs );
+    for ( int j = 0; j < num_vars && error == 0; j++ ) {
+      var_names[j] = deserialize_string();
+      if ( var_names[j] == NULL ) error = GRB_ERROR_OUT_OF_MEMORY;
+    }
+    for ( int i = 0; i < num_constrs && error == 0; i++ ) {
+      constr_names[i] = deserialize_string();
+      if ( constr_names[i] == NULL ) error = GRB_ERROR_OUT_OF_MEMORY;
+    }
+  }
+  if ( error == 0 ) {
+    for ( int j = 0; j < num_vars; j++ ) {
+      len[j] = ( j + 1 < num_vars ? beg[j + 1] : num_nz ) - beg[j];
+    }
+    error = GU_TIMED( NULL, GRBXloadmodel( env, &model, model_name, num_vars, num_constrs,
+					   obj_sense, obj_con, obj, sense, rhs,
+					   beg, len, ind, val, lb, ub, vtype,
+					   var_names, constr_names ) );
+  }
+
+  // parameters, set in the environment of the new model
+  if ( error == 0 ) {
+    error = deserialize_params( GRBgetenv( model ) );
+  }
+
+  free( model_name );
+  free( beg );
+  free( len );
+  free( ind );
+  free( val );
+  free( obj );
+  free( lb );
+  free( ub );
+  free( vtype );
+  free( sense );
+  free( rhs );
+  for ( int j = 0; var_names != NULL && j < num_vars; j++ ) {
+    free( var_names[j] );
+  }
+  for ( int i = 0; constr_names != NULL && i < num_constrs; i++ ) {
+    free( constr_names[i] );
+  }
+  free( var_names );
+  free( constr_names );
+
+  if ( error != 0 ) {
+    GRBfreemodel( model );
+    caml_deserialize_error( "gurobi.model: cannot load model" );
+  }
+
+  struct gu_model* block = dst;
+  block->model = model;
+  block->callback = NULL;
+  block->log_buffer = NULL;
+  block->env = NULL;
+  block->mem = model_mem_estimate( model );
+  block->busy = 0;
+  caml_adjust_gc_speed( block->mem, GU_MODEL_MEM_MAX );
+  set_root( &block->log_buffer, root_value( env_block( gu_deserialization_env )->log_buffer ) );
+  set_root( &block->env, gu_deserialization_env );
+  env_block( gu_deserialization_env )->num_models++;
+  return sizeof(struct gu_model);
+}
+
+// callbacks. Gurobi invokes callbacks from within the functions that
+// release the runtime lock (optimize and friends), possibly on a
+// thread that OCaml does not know about, so the trampoline registers
+// the thread if needed (and unregisters it afterwards, if it did the
+// registering) and reacquires the lock before calling the closure. Where codes that the closure is not interested in are
+// filtered out before the lock is taken.
+static int __stdcall gu_callback_trampoline(
+  GRBmodel* model,
+  void* cbdata,
+  int where,
+  void* usrdata
+)
+{
+  struct gu_callback* callback = usrdata;
+  if ( where < 0 || where >= 32 || !(callback->wheres & (1u << where)) ) {
+    return 0;
+  }
+
+  // 0 if the thread was already registered
+  int registered = caml_c_thread_register();
+  caml_acquire_runtime_system();
+
+  struct gu_cbctx* ctx = cbctx_val( callback->v_ctx );
+  ctx->cbdata = cbdata;
+  ctx->where = where;
+  value v_res = caml_callback2_exn( callback->closure, callback->v_ctx, Val_int( where ) );
+  // the context may have been moved by the GC during the callback
+  ctx = cbctx_val( callback->v_ctx );
+  ctx->cbdata = NULL;
+
+  // an exception escaping the closure aborts the optimization, and is
+  // re-raised once it has stopped, by gu_callback_reraise
+  int error = 0;
+  if ( Is_exception_result( v_res ) ) {
+    if ( callback->exn == Val_unit ) {
+      caml_modify_generational_global_root( &callback->exn, Extract_exception( v_res ) );
+    }
+    error = GRB_ERROR_CALLBACK;
+  }
+
+  caml_release_runtime_system();
+  if ( registered ) {
+    caml_c_thread_unregister();
+  }
+  return error;
+}
+
+// record the number of variables, which bounds the size of solution
+// vectors returned by GRBcbget, and size the scratch buffer of the
+// scalar getters accordingly. Pending modifications are processed
+// first, as GRBoptimize would do anyway.
+static void gu_callback_prepare( value v_model )
+{
+  struct gu_model* block = model_block( v_model );
+  if ( block->callback != NULL ) {
+    struct gu_cbctx* ctx = cbctx_val( block->callback->v_ctx );
+    caml_modify_generational_global_root( &block->callback->exn, Val_unit );
+    int num_vars = 0;
+    GU_TIMED( NULL, GRBupdatemodel( block->model ) );
+    GU_TIMED( GRB_INT_ATTR_NUMVARS, GRBgetintattr( block->model, GRB_INT_ATTR_NUMVARS, &num_vars ) );
+    double* scratch = realloc( ctx->scratch, (num_vars > 0 ? num_vars : 1) * sizeof(double) );
+    if ( scratch == NULL ) {
+      caml_raise_out_of_memory();
+    }
+    ctx->scratch = scratch;
+    ctx->num_vars = num_vars;
+  }
+}
+
+// raise the exception that escaped the callback of v_model during
+// the optimization that has just completed, if any
+static void gu_callback_reraise( value v_model )
+{
+  struct gu_callback* callback = model_block( v_model )->callback;
+  if ( callback != NULL && callback->exn != Val_unit ) {
+    value exn = callback->exn;
+    caml_modify_generational_global_root( &callback->exn, Val_unit );
+    caml_raise( exn );
+  }
+}
+
+CAMLprim value gu_set_callback_func( value v_model, value v_wheres_opt, value v_callback_opt )
+{
+  CAMLparam3( v_model, v_wheres_opt, v_callback_opt );
+  CAMLlocal2( v_ctx, v_wheres );
+
+  GRBmodel* model = model_val( v_model );
+  int error;
+
+  if ( Is_some( v_callback_opt ) ) {
+    unsigned int wheres = ~0u;
+    if ( Is_some( v_wheres_opt ) ) {
+      wheres = 0;
+      for ( v_wheres = Some_val( v_wheres_opt );
+            v_wheres != Val_emptylist;
+            v_wheres = Field( v_wheres, 1 ) ) {
+        int where = Int_val( Field( v_wheres, 0 ) );
+        if ( where < 0 || where >= 32 ) {
+          caml_invalid_argument( "set_callback_func:wheres" );
+        }
+        wheres |= 1u << where;
+      }
+    }
+
+    struct gu_callback* callback = model_block( v_model )->callback;
+    if ( callback == NULL ) {
+      v_ctx = caml_alloc_custom( &cbctx_ops, sizeof(struct gu_cbctx), 0, 1 );
+      struct gu_cbctx* ctx = cbctx_val( v_ctx );
+      ctx->model = model;
+      ctx->cbdata = NULL;
+      ctx->where = -1;
+      ctx->num_vars = 0;
+      ctx->scratch = NULL;
+
+      callback = malloc( sizeof(struct gu_callback) );
+      if ( callback == NULL ) {
+        caml_raise_out_of_memory();
+      }
+      callback->closure = Some_val( v_callback_opt );
+      callback->v_ctx = v_ctx;
+      callback->exn = Val_unit;
+      caml_register_generational_global_root( &callback->closure );
+      caml_register_generational_global_root( &callback->v_ctx );
+      caml_register_generational_global_root( &callback->exn );
+      // re-read the block, the allocation above may have moved it
+      model_block( v_model )->callback = callback;
+    }
+    else {
+      caml_modify_generational_global_root( &callback->closure, Some_val( v_callback_opt ) );
+    }
+    callback->wheres = wheres;
+    error = GU_TIMED( NULL, GRBsetcallbackfunc( model, gu_callback_trampoline, callback ) );
+  }
+  else {
+    error = GU_TIMED( NULL, GRBsetcallbackfunc( model, NULL, NULL ) );
+    struct gu_callback* callback = model_block( v_model )->callback;
+    if ( error == 0 && callback != NULL ) {
+      gu_callback_free( callback );
+      model_block( v_model )->callback = NULL;
+    }
+  }
+  CAMLreturn( Val_int( error ) );
+}
+
+// GRBcbget, for the what codes whose result is a double. The result
+// is written into the scratch buffer of the context, which has one
+// element per variable, so that a vector what code such as
+// GRB_CB_MIPSOL_SOL cannot overflow it.
+double gu_cb_get_float( value v_ctx, value v_what )
+{
+  struct gu_cbctx* ctx = cbctx_val( v_ctx );
+  if ( ctx->cbdata == NULL || ctx->scratch == NULL ) {
+    caml_invalid_argument( "cb_get_float:ctx" );
+  }
+  ctx->scratch[0] = 0.0;
+  int error = GU_TIMED( NULL, GRBcbget( ctx->cbdata, ctx->where, Int_val( v_what ), ctx->scratch ) );
+  if ( error != 0 ) {
+    raise_error( error );
+  }
+  return ctx->scratch[0];
+}
+
+CAMLprim value gu_cb_get_float_bc( value v_ctx, value v_what )
+{
+  return caml_copy_double( gu_cb_get_float( v_ctx, v_what ) );
+}
+
+// GRBcbget, for the what codes whose result is an int, also written
+// into the scratch buffer
+intnat gu_cb_get_int( value v_ctx, value v_what )
+{
+  struct gu_cbctx* ctx = cbctx_val( v_ctx );
+  if ( ctx->cbdata == NULL || ctx->scratch == NULL ) {
+    caml_invalid_argument( "cb_get_int:ctx" );
+  }
+  int* result = (int*)ctx->scratch;
+  *result = 0;
+  int error = GU_TIMED( NULL, GRBcbget( ctx->cbdata, ctx->where, Int_val( v_what ), result ) );
+  if ( error != 0 ) {
+    raise_error( error );
+  }
+  return *result;
+}
+
+CAMLprim value gu_cb_get_int_bc( value v_ctx, value v_what )
+{
+  return Val_long( gu_cb_get_int( v_ctx, v_what ) );
+}
+
+// GRBcbget, for the what codes whose result is a string, whose
+// pointer is also written into the scratch buffer
+CAMLprim value gu_cb_get_str( value v_ctx, value v_what )
+{
+  CAMLparam2( v_ctx, v_what );
+  CAMLlocal1( v_res );
+  struct gu_cbctx* ctx = cbctx_val( v_ctx );
+  if ( ctx->cbdata == NULL || ctx->scratch == NULL ) {
+    caml_invalid_argument( "cb_get_str:ctx" );
+  }
+  char** result = (char**)ctx->scratch;
+  *result = NULL;
+  int error = GU_TIMED( NULL, GRBcbget( ctx->cbdata, ctx->where, Int_val( v_what ), result ) );
+  char* s = *result;
+  if ( error == 0 ) {
+    // Ok s
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, caml_copy_string( s == NULL ? "" : s ) );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+// GRBcbget, for the what codes whose result is a vector with one
+// element per variable, such as GRB_CB_MIPSOL_SOL; the vector is
+// written into a caller-supplied bigarray
+CAMLprim value gu_cb_get_solution( value v_ctx, value v_what, value v_dst )
+{
+  CAMLparam3( v_ctx, v_what, v_dst );
+  struct gu_cbctx* ctx = cbctx_val( v_ctx );
+  if ( ctx->cbdata == NULL ) {
+    caml_invalid_argument( "cb_get_solution:ctx" );
+  }
+  double* dst = get_fa( v_dst, ctx->num_vars );
+  if ( dst == NULL ) {
+    caml_invalid_argument( "cb_get_solution:dst" );
+  }
+  int error = GU_TIMED( NULL, GRBcbget( ctx->cbdata, ctx->where, Int_val( v_what ), dst ) );
+  CAMLreturn( Val_int( error ) );
+}
+
+// inject a (possibly partial) solution, e.g. one found by a user
+// heuristic, from within a callback
+CAMLprim value gu_cb_solution( value v_ctx, value v_solution )
+{
+  CAMLparam2( v_ctx, v_solution );
+  CAMLlocal1( v_res );
+  struct gu_cbctx* ctx = cbctx_val( v_ctx );
+  if ( ctx->cbdata == NULL ) {
+    caml_invalid_argument( "cb_solution:ctx" );
+  }
+  double* solution = get_fa( v_solution, ctx->num_vars );
+  if ( solution == NULL ) {
+    caml_invalid_argument( "cb_solution:solution" );
+  }
+  double obj = GRB_INFINITY;
+  int error = GU_TIMED( NULL, GRBcbsolution( ctx->cbdata, solution, &obj ) );
+  if ( error == 0 ) {
+    // Ok obj
+    v_res = caml_alloc(1, 0);
+    Store_field( v_res, 0, caml_copy_double(obj) );
+  }
+  else {
+    // Error code
+    v_res = caml_alloc(1, 1);
+    Store_field( v_res, 0, Val_int(error) );
+  }
+  CAMLreturn( v_res );
+}
+
+// add a batch of lazy constraints (lazy == true) or user cuts, given
+// in compressed sparse row form, from within a callback, stopping at
+// the first error reported by Gurobi
+static int cb_add_rows(
+  value v_ctx,
+  value v_num,
+  value v_compressed,
+  value v_sense,
+  value v_rhs,
+  bool lazy
+)
+{
+  const char* who = lazy ? "cb_lazy" : "cb_cut";
+  char msg[64];
+  struct gu_cbctx* ctx = cbctx_val( v_ctx );
+  int num = Int_val( v_num );
+  int num_nz = Int_val( Field( v_compressed, 0 ) );
+
+  int* c_beg = get_i32a( Field( v_compressed, 1 ), num );
+  int* c_ind = get_i32a( Field( v_compressed, 2 ), num_nz );
+  double* c_val = get_fa( Field( v_compressed, 3 ), num_nz );
+  char* sense = get_ca( v_sense, num );
+  double* rhs = get_fa( v_rhs, num );
+  if ( c_beg == NULL || c_ind == NULL || c_val == NULL || sense == NULL || rhs == NULL ) {
+    snprintf( msg, sizeof(msg), "%s:(compressed,sense,rhs)", who );
+    caml_invalid_argument( msg );
+  }
+
+  if ( ctx->cbdata == NULL ) {
+    snprintf( msg, sizeof(msg), "%s:ctx", who );
+    caml_invalid_argument( msg );
+  }
+
+  // all the rows are checked before any is submitted, so that an
+  // invalid batch is rejected as a whole
+  for (int i = 0; i < num; i++ ) {
+    int beg = c_beg[i];
+    int end = ( i + 1 < num ) ? c_beg[i+1] : num_nz;
+    if ( beg < 0 || beg > end || end > num_nz ) {
+      snprintf( msg, sizeof(msg), "%s:compressed.beg", who );
+      caml_invalid_argument( msg );
+    }
+  }
+
+  for (int i = 0; i < num; i++ ) {
+    int beg = c_beg[i];
+    int end = ( i + 1 < num ) ? c_beg[i+1] : num_nz;
+    int error = GU_TIMED( NULL, lazy
+      ? GRBcblazy( ctx->cbdata, end - beg, c_ind + beg, c_val + beg, sense[i], rhs[i] )
+      : GRBcbcut( ctx->cbdata, end - beg, c_ind + beg, c_val + beg, sense[i], rhs[i] ) );
+    if ( error != 0 ) {
+      return error;
+    }
+  }
+  return 0;
+}
+
+CAMLprim value gu_cb_lazy( value v_ctx, value v_num, value v_compressed, value v_sense, value v_rhs )
+{
+  CAMLparam5( v_ctx, v_num, v_compressed, v_sense, v_rhs );
+  int error = cb_add_rows( v_ctx, v_num, v_compressed, v_sense, v_rhs, true );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_cb_cut( value v_ctx, value v_num, value v_compressed, value v_sense, value v_rhs )
+{
+  CAMLparam5( v_ctx, v_num, v_compressed, v_sense, v_rhs );
+  int error = cb_add_rows( v_ctx, v_num, v_compressed, v_sense, v_rhs, false );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_cb_terminate( value v_ctx )
+{
+  CAMLparam1( v_ctx );
+  GRBterminate( cbctx_val( v_ctx )->model );
+  CAMLreturn( Val_unit );
+}
+
+// The following functions may run for a long time inside Gurobi, so
+// they release the OCaml runtime lock for the duration of the call,
+// letting other OCaml threads make progress. Anything they need from
+// the OCaml heap must be copied out beforehand, since heap blocks may
+// be moved by the GC while the lock is released.
+CAMLprim value gu_optimize( value v_model )
+{
+  CAMLparam1( v_model );
+  GRBmodel* model = model_val( v_model );
+  gu_callback_prepare( v_model );
+  hold( model_block(v_model) );
+  caml_enter_blocking_section();
+  int error = GU_TIMED( NULL, GRBoptimize( model ) );
+  caml_leave_blocking_section();
+  unhold( model_block(v_model) );
+  refresh_model_mem( model_block(v_model) );
+  gu_callback_reraise( v_model );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_write( value v_model, value v_path )
+{
+  CAMLparam2( v_model, v_path );
+  GRBmodel* model = model_val( v_model );
+  char* path = strdup( String_val( v_path ) );
+  if ( path == NULL ) {
+    caml_raise_out_of_memory();
+  }
+  hold( model_block(v_model) );
+  caml_enter_blocking_section();
+  int error = GU_TIMED( NULL, GRBwrite( model, path ) );
+  caml_leave_blocking_section();
+  unhold( model_block(v_model) );
+  free( path );
+  CAMLreturn( Val_int( error ) );
+}
+
+CAMLprim value gu_compute_iis( value v_model )
+{
+  CAMLparam1( v_model );
+  GRBmodel* model = model_val( v_model );
+  gu_callback_prepare( v_model );
+  hold( model_block(v_model) );
+  caml_enter_blocking_section();
+  int error = GU_TIMED( NULL, GRBcomputeIIS( model ) );
+  caml_leave_blocking_section();
+  unhold( model_block(v_model) );
+  gu_callback_reraise( v_model );
+  CAMLreturn( Val_int( error ) );
+}
+
+// asynchronous optimization: GRBoptimize runs on a native thread,
+// while the caller gets a handle that it can poll, wait on, or
+// cancel. Completion is also signalled by making the read end of a
+// pipe readable, so that the handle can be integrated into an event
+// loop (select, poll, epoll).
+
+enum { SOLVE_RUNNING, SOLVE_FINISHED, SOLVE_ORPHANED };
+
+struct gu_solve {
+  GRBmodel* model;
+  value v_model;     // generational global root, keeps the model alive
+  pthread_t thread;
+  int error;
+  atomic_int state;
+  int fds[2];        // a byte is written to fds[1] when the solve ends
+  int held;          // the model is held, see hold
+};
+
+#define solve_val(v) (*((struct gu_solve **) Data_custom_val(v)))
+
+// give the model back, once the thread is done with it; with the
+// runtime lock held
+static void gu_solve_unhold( struct gu_solve* solve )
+{
+  if ( solve->held ) {
+    unhold( model_block( solve->v_model ) );
+    solve->held = 0;
+  }
+}
+
+// must be called with the runtime lock held, once the thread is done
+static void gu_solve_free( struct gu_solve* solve )
+{
+  gu_solve_unhold( solve );
+  caml_remove_generational_global_root( &solve->v_model );
+  close( solve->fds[0] );
+  close( solve->fds[1] );
+  free( solve );
+}
+
+static void* gu_solve_thread( void* arg )
+{
+  struct gu_solve* solve = arg;
+  solve->error = GU_TIMED( NULL, GRBoptimize( solve->model ) );
+
+  char c = 0;
+  ssize_t n;
+  do {
+    n = write( solve->fds[1], &c, 1 );
+  } while ( n < 0 && errno == EINTR );
+
+  int expected = SOLVE_RUNNING;
+  if ( !atomic_compare_exchange_strong( &solve->state, &expected, SOLVE_FINISHED ) ) {
+    // the handle was collected while we were running, so we are
+    // responsible for releasing the resources. Callbacks unregister
+    // this thread when they are done, so it is registered here.
+    int registered = caml_c_thread_register();
+    caml_acquire_runtime_system();
+    gu_solve_free( solve );
+    caml_release_runtime_system();
+    if ( registered ) {
+      caml_c_thread_unregister();
+    }
+  }
+  // otherwise, solve now belongs to the finalizer of the handle
+  return NULL;
+}
+
+void gu_solve_finalize( value v_solve )
+{
+  struct gu_solve* solve = solve_val( v_solve );
+  if ( solve == NULL ) {
+    // the thread could not be started
+    return;
+  }
+  // the thread is never joined here: it may be waiting for the
+  // runtime lock, which the GC holds while running this finalizer
+  pthread_detach( solve->thread );
+  int expected = SOLVE_RUNNING;
+  if ( atomic_compare_exchange_strong( &solve->state, &expected, SOLVE_ORPHANED ) ) {
+    // still running: ask Gurobi to stop, and let the thread clean up
+    // after itself
+    GRBterminate( solve->model );
+  }
+  else {
+    // finished: the thread no longer uses solve
+    gu_solve_free( solve );
+  }
+}
+
+static struct custom_operations solve_ops = {
+  "gurobi.solve",
+  gu_solve_finalize,
+  custom_compare_default,
+  custom_hash_default,
+  custom_serialize_default,
+  custom_deserialize_default,
+  custom_compare_ext_default,
+  custom_fixed_length_default
+};
+
+CAMLprim value gu_optimize_async( value v_model )
+{
+  CAMLparam1( v_model );
+  CAMLlocal1( v_solve );
+
+  // allocate the handle before starting the thread, so that we do
+  // not have to stop a running solve if the allocation fails
+  v_solve = caml_alloc_custom( &solve_ops, sizeof(struct gu_solve*), 0, 1 );
+  solve_val( v_solve ) = NULL;
+
+  struct gu_solve* solve = malloc( sizeof(struct gu_solve) );
+  if ( solve == NULL ) {
+    caml_raise_out_of_memory();
+  }
+  if ( pipe( solve->fds ) != 0 ) {
+    free( solve );
+    caml_failwith( "optimize_async:pipe" );
+  }
+  gu_callback_prepare( v_model );
+  solve->model = model_val( v_model );
+  solve->v_model = v_model;
+  solve->error = 0;
+  atomic_init( &solve->state, SOLVE_RUNNING );
+  caml_register_generational_global_root( &solve->v_model );
+  hold( model_block( v_model ) );
+  solve->held = 1;
+
+  if ( pthread_create( &solve->thread, NULL, gu_solve_thread, solve ) != 0 ) {
+    gu_solve_free( solve );
+    caml_failwith( "optimize_async:pthread_create" );
+  }
+  solve_val( v_solve ) = solve;
+  CAMLreturn( v_solve );
+}
+
+CAMLprim value gu_async_poll( value v_solve )
+{
+  CAMLparam1( v_solve );
+  CAMLlocal1( v_res );
+  struct gu_solve* solve = solve_val( v_solve );
+  if ( atomic_load( &solve->state ) == SOLVE_RUNNING ) {
+    v_res = Val_none;
+  }
+  else {
+    gu_solve_unhold( solve );
+    gu_callback_reraise( solve->v_model );
+    v_res = caml_alloc_some( Val_int( solve->error ) );
+  }
+  CAMLreturn( v_res );
+}
+
+CAMLprim value gu_async_wait( value v_solve )
+{
+  CAMLparam1( v_solve );
+  struct gu_solve* solve = solve_val( v_solve );
+  if ( atomic_load( &solve->state ) == SOLVE_RUNNING ) {
+    // wait on the pipe rather than joining: the thread is detached
+    // by the finalizer
+    char c;
+    ssize_t n;
+    caml_enter_blocking_section();
+    do {
+      n = read( solve->fds[0], &c, 1 );
+    } while ( n < 0 && errno == EINTR );
+    caml_leave_blocking_section();
+    if ( n == 1 ) {
+      // keep the descriptor readable for event loops
+      do {
+        n = write( solve->fds[1], &c, 1 );
+      } while ( n < 0 && errno == EINTR );
+    }
+    while ( atomic_load( &solve->state ) == SOLVE_RUNNING ) {
+      // the byte is written just before the state changes
+      sched_yield();
+    }
+  }
+  gu_solve_unhold( solve );
+  gu_callback_reraise( solve->v_model );
+  CAMLreturn( Val_int( solve->error ) );
+}
+
+CAMLprim value gu_async_cancel( value v_solve )
+{
+  CAMLparam1( v_solve );
+  struct gu_solve* solve = solve_val( v_solve );
+  GRBterminate( solve->model );
+  CAMLreturn( Val_unit );
+}
+
+CAMLprim value gu_async_fd( value v_solve )
+{
+  CAMLparam1( v_solve );
+  struct gu_solve* solve = solve_val( v_solve );
+  CAMLreturn( Val_int( solve->fds[0] ) );
+}
+
+CAMLprim value gu_set_objective_n(
+  value v_model,
+  value v_index,
+  value	v_priority,
+  value v_weight,
+  value	v_abstol,
+  value v_reltol,
+  value v_name_opt,
+  value v_constant,
+  value	v_nnz,
+  value	v_ind,
+  value	v_val
+)
+{
+  CAMLparam5( v_model, v_index, v_priority, v_weight, v_abstol );
+  CAMLxparam5( v_reltol, v_name_opt, v_constant, v_nnz, v_ind );
+  CAMLxparam1( v_val );
+  CAMLlocal1( v_name );
+
+  GRBmodel* model = model_val( v_model );
+  int index = Int_val( v_index );
+  int priority = Int_val( v_priority );
+  double weight = Double_val( v_weight );
+  double abstol = Double_val( v_abstol );
+  double reltol = Double_val( v_reltol );
+
+  // name, optional
+  const char* name = NULL;
   if ( Is_some( v_name_opt ) ) {
     v_name = Some_val( v_name_opt );
     name = String_val( v_name );
@@ -2001,7 +4908,7 @@ CAMLprim value gu_set_objective_n(
     caml_invalid_argument( "set_objective_n:<val>" );
   }
 
-  int error = GRBsetobjectiven(model,
+  int error = GU_TIMED( NULL, GRBsetobjectiven(model,
 			       index,
 			       priority,
 			       weight,
@@ -2011,7 +4918,7 @@ CAMLprim value gu_set_objective_n(
 			       constant,
 			       nnz,
 			       ind,
-			       val );
+			       val ) );
   CAMLreturn( Val_int( error ) );
 }
 
@@ -2049,6 +4956,139 @@ CAMLprim value gu_set_pwl_obj(
   double* x = get_fa( v_x, n_points );
   double* y = get_fa( v_y, n_points );
 
-  int error = GRBsetpwlobj(model, var, n_points, x, y);
+  int error = GU_TIMED( NULL, GRBsetpwlobj(model, var, n_points, x, y) );
   CAMLreturn( Val_int( error ) );
 }
+
+// Fast paths for scalar attributes. These are called as [@@noalloc]
+// externals with unboxed floats and untagged ints: they neither
+// allocate nor raise. Getters report the Gurobi error code in the
+// first element of the err bigarray (left untouched if it is empty),
+// setters return it.
+
+// a freed model is reported as GRB_ERROR_NULL_ARGUMENT, rather than
+// raising as model_val does; timed under the attribute v_name, which
+// must be in scope
+#define fast_model(v) (model_block(v)->model)
+#define FAST_CALL(v_model, name, call) \
+  ( fast_model(v_model) == NULL ? GRB_ERROR_NULL_ARGUMENT \
+    : GU_TIMED( name, call ) )
+
+static void set_err( value v_err, int error )
+{
+  int* err = get_i32a( v_err, 1 );
+  if ( err != NULL ) {
+    err[0] = error;
+  }
+}
+
+double gu_fast_get_float_attr_element( value v_model, value v_name, intnat index, value v_err )
+{
+  double d = 0.0;
+  set_err( v_err, FAST_CALL( v_model, String_val(v_name), GRBgetdblattrelement( fast_model(v_model), String_val(v_name), index, &d ) ) );
+  return d;
+}
+
+CAMLprim value gu_fast_get_float_attr_element_bc( value v_model, value v_name, value v_index, value v_err )
+{
+  return caml_copy_double( gu_fast_get_float_attr_element( v_model, v_name, Long_val(v_index), v_err ) );
+}
+
+intnat gu_fast_set_float_attr_element( value v_model, value v_name, intnat index, double d )
+{
+  return FAST_CALL( v_model, String_val(v_name), GRBsetdblattrelement( fast_model(v_model), String_val(v_name), index, d ) );
+}
+
+CAMLprim value gu_fast_set_float_attr_element_bc( value v_model, value v_name, value v_index, value v_d )
+{
+  return Val_long( gu_fast_set_float_attr_element( v_model, v_name, Long_val(v_index), Double_val(v_d) ) );
+}
+
+intnat gu_fast_get_int_attr_element( value v_model, value v_name, intnat index, value v_err )
+{
+  int i = 0;
+  set_err( v_err, FAST_CALL( v_model, String_val(v_name), GRBgetintattrelement( fast_model(v_model), String_val(v_name), index, &i ) ) );
+  return i;
+}
+
+CAMLprim value gu_fast_get_int_attr_element_bc( value v_model, value v_name, value v_index, value v_err )
+{
+  return Val_long( gu_fast_get_int_attr_element( v_model, v_name, Long_val(v_index), v_err ) );
+}
+
+intnat gu_fast_set_int_attr_element( value v_model, value v_name, intnat index, intnat i )
+{
+  return FAST_CALL( v_model, String_val(v_name), GRBsetintattrelement( fast_model(v_model), String_val(v_name), index, i ) );
+}
+
+CAMLprim value gu_fast_set_int_attr_element_bc( value v_model, value v_name, value v_index, value v_i )
+{
+  return Val_long( gu_fast_set_int_attr_element( v_model, v_name, Long_val(v_index), Long_val(v_i) ) );
+}
+
+// chars are immediate values, so they are passed and returned as such
+value gu_fast_get_char_attr_element( value v_model, value v_name, intnat index, value v_err )
+{
+  char c = 0;
+  set_err( v_err, FAST_CALL( v_model, String_val(v_name), GRBgetcharattrelement( fast_model(v_model), String_val(v_name), index, &c ) ) );
+  return Val_int( (unsigned char)c );
+}
+
+CAMLprim value gu_fast_get_char_attr_element_bc( value v_model, value v_name, value v_index, value v_err )
+{
+  return gu_fast_get_char_attr_element( v_model, v_name, Long_val(v_index), v_err );
+}
+
+intnat gu_fast_set_char_attr_element( value v_model, value v_name, intnat index, value v_c )
+{
+  return FAST_CALL( v_model, String_val(v_name), GRBsetcharattrelement( fast_model(v_model), String_val(v_name), index, Int_val(v_c) ) );
+}
+
+CAMLprim value gu_fast_set_char_attr_element_bc( value v_model, value v_name, value v_index, value v_c )
+{
+  return Val_long( gu_fast_set_char_attr_element( v_model, v_name, Long_val(v_index), v_c ) );
+}
+
+double gu_fast_get_float_attr( value v_model, value v_name, value v_err )
+{
+  double d = 0.0;
+  set_err( v_err, FAST_CALL( v_model, String_val(v_name), GRBgetdblattr( fast_model(v_model), String_val(v_name), &d ) ) );
+  return d;
+}
+
+CAMLprim value gu_fast_get_float_attr_bc( value v_model, value v_name, value v_err )
+{
+  return caml_copy_double( gu_fast_get_float_attr( v_model, v_name, v_err ) );
+}
+
+intnat gu_fast_set_float_attr( value v_model, value v_name, double d )
+{
+  return FAST_CALL( v_model, String_val(v_name), GRBsetdblattr( fast_model(v_model), String_val(v_name), d ) );
+}
+
+CAMLprim value gu_fast_set_float_attr_bc( value v_model, value v_name, value v_d )
+{
+  return Val_long( gu_fast_set_float_attr( v_model, v_name, Double_val(v_d) ) );
+}
+
+intnat gu_fast_get_int_attr( value v_model, value v_name, value v_err )
+{
+  int i = 0;
+  set_err( v_err, FAST_CALL( v_model, String_val(v_name), GRBgetintattr( fast_model(v_model), String_val(v_name), &i ) ) );
+  return i;
+}
+
+CAMLprim value gu_fast_get_int_attr_bc( value v_model, value v_name, value v_err )
+{
+  return Val_long( gu_fast_get_int_attr( v_model, v_name, v_err ) );
+}
+
+intnat gu_fast_set_int_attr( value v_model, value v_name, intnat i )
+{
+  return FAST_CALL( v_model, String_val(v_name), GRBsetintattr( fast_model(v_model), String_val(v_name), i ) );
+}
+
+CAMLprim value gu_fast_set_int_attr_bc( value v_model, value v_name, value v_i )
+{
+  return Val_long( gu_fast_set_int_attr( v_model, v_name, Long_val(v_i) ) );
+}
@@ -0,0 +1,86 @@
+(** Per-stub call counters and latency histograms, to find which calls to
+    Gurobi dominate a workload.
+
+    Instrumentation is off by default, and then costs a single branch per call
+    to Gurobi. It is turned on by {!enable}, or at startup by setting the
+    [GUROOBI_INSTRUMENT] environment variable, e.g. to [1].
+
+    {[
+      Instrument.enable ();
+      (* ... *)
+      print_endline (Instrument.to_string (Instrument.snapshot ()))
+    ]} *)
+
+type stat = {
+  stub : string;  (** the C stub, e.g. [gu_get_float_attr_element] *)
+  name : string;  (** the attribute or parameter, [""] if none *)
+  calls : int;
+  errors : int;  (** calls returning a non-zero error code *)
+  total_ns : int;
+  max_ns : int;
+  histogram : int array;
+      (** [histogram.(i)] is the number of calls of [2^i] to [2^(i+1)] ns,
+          the first and last buckets also counting the shorter and longer
+          calls *)
+}
+
+type snapshot = {
+  stats : stat list;  (** by decreasing [total_ns] *)
+  dropped : int;  (** calls not recorded, there being too many names *)
+}
+
+let enable () = Raw.instrument_enable true
+let disable () = Raw.instrument_enable false
+let enabled () = Raw.instrument_enabled ()
+
+(** [reset ()] clears all the counters *)
+let reset () = Raw.instrument_reset ()
+
+(** [snapshot ()] is a copy of the counters *)
+let snapshot () =
+  let stats, dropped = Raw.instrument_snapshot () in
+  let stats =
+    Array.to_list
+      (Array.map
+         (fun (stub, name, calls, errors, total_ns, max_ns, histogram) ->
+           { stub; name; calls; errors; total_ns; max_ns; histogram })
+         stats)
+  in
+  {
+    stats = List.sort (fun a b -> compare b.total_ns a.total_ns) stats;
+    dropped;
+  }
+
+(** [find s ~stub ?name ()] is the counters of [stub] for attribute or
+    parameter [name] (by default, [""]) *)
+let find s ~stub ?(name = "") () =
+  List.find_opt (fun t -> t.stub = stub && t.name = name) s.stats
+
+let stat_to_json t =
+  let buckets = ref [] in
+  Array.iteri
+    (fun i n ->
+      if n > 0 then buckets := (string_of_int (1 lsl i), `Int n) :: !buckets)
+    t.histogram;
+  `Assoc
+    [
+      ("stub", `String t.stub);
+      ("name", `String t.name);
+      ("calls", `Int t.calls);
+      ("errors", `Int t.errors);
+      ("total_ns", `Int t.total_ns);
+      ("max_ns", `Int t.max_ns);
+      ("mean_ns", `Float (float t.total_ns /. float (max 1 t.calls)));
+      ("histogram", `Assoc (List.rev !buckets));
+    ]
+
+(** [to_json s] is [s] as JSON; the non-empty buckets of each histogram are
+    keyed by their lower bound, in ns *)
+let to_json s : Yojson.Basic.t =
+  `Assoc
+    [
+      ("stats", `List (List.map stat_to_json s.stats));
+      ("dropped", `Int s.dropped);
+    ]
+
+let to_string s = Yojson.Basic.pretty_to_string (to_json s)
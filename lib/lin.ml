@@ -0,0 +1,165 @@
+(** A builder of linear constraints, which adds them to a model in blocks.
+
+    Terms are accumulated directly into growable bigarrays laid out as the
+    CSR matrix that {!Raw.add_constrs} takes, with no intermediate OCaml
+    arrays or lists. Terms of the same variable within a constraint are
+    merged, and terms whose coefficients add up to zero are dropped. Once the
+    block holds [chunk_nz] nonzeros, it is added to the model with a single
+    call to {!Raw.add_constrs}, so that the memory used by the builder does
+    not depend on the number of constraints built.
+
+    {[
+      let b = Lin.create model in
+      (* 2 x0 + x1 - x0 <= 4 *)
+      Lin.term b 0 2.0;
+      Lin.term b 1 1.0;
+      Lin.term b 0 (-1.0);
+      Lin.row b GRB.less_equal 4.0;
+      Lin.flush b
+    ]}
+
+    Errors raise [Raw.Gurobi_error]. *)
+
+open Bigarray
+
+type t = {
+  model : Raw.model;
+  chunk_nz : int;
+  mutable beg : Raw.i32a;
+  mutable ind : Raw.i32a;
+  mutable value : Raw.fa;
+  mutable sense : Raw.ca;
+  mutable rhs : Raw.fa;
+  mutable num_rows : int;
+  mutable num_nz : int;
+  mutable row_first : int;  (** first nonzero of the row being built *)
+  mutable constant : float;  (** of the row being built *)
+  mutable marker : int array;
+      (** [marker.(v)] is the position of variable [v] in the row being
+          built, if it is at least [row_first] and [ind] holds [v] there *)
+  mutable added : int;  (** rows added to the model so far *)
+}
+
+let grow_i32 a n =
+  let b = Array1.create int32 c_layout (max n (2 * Array1.dim a)) in
+  Array1.blit a (Array1.sub b 0 (Array1.dim a));
+  b
+
+let grow_f a n =
+  let b = Array1.create float64 c_layout (max n (2 * Array1.dim a)) in
+  Array1.blit a (Array1.sub b 0 (Array1.dim a));
+  b
+
+let grow_c a n =
+  let b = Array1.create char c_layout (max n (2 * Array1.dim a)) in
+  Array1.blit a (Array1.sub b 0 (Array1.dim a));
+  b
+
+(** [create ?chunk_nz model] is a builder of constraints of [model], which
+    adds them once [chunk_nz] (default: 2{^ 20}) nonzeros are pending *)
+let create ?(chunk_nz = 1 lsl 20) model =
+  if chunk_nz < 1 then invalid_arg "Lin.create: chunk_nz";
+  {
+    model;
+    chunk_nz;
+    beg = Utils.i32a 1024;
+    ind = Utils.i32a 4096;
+    value = Utils.fa 4096;
+    sense = Utils.ca 1024;
+    rhs = Utils.fa 1024;
+    num_rows = 0;
+    num_nz = 0;
+    row_first = 0;
+    constant = 0.0;
+    marker = Array.make 1024 (-1);
+    added = 0;
+  }
+
+(** [term b var coef] adds [coef] times variable [var] to the constraint
+    being built *)
+let term b var coef =
+  if var < 0 then invalid_arg "Lin.term: var";
+  if var >= Array.length b.marker then (
+    let n = Array.length b.marker in
+    let marker = Array.make (max (var + 1) (2 * n)) (-1) in
+    Array.blit b.marker 0 marker 0 n;
+    b.marker <- marker);
+  let k = b.marker.(var) in
+  if k >= b.row_first && k < b.num_nz && Int32.to_int b.ind.{k} = var then
+    b.value.{k} <- b.value.{k} +. coef
+  else (
+    if b.num_nz = Array1.dim b.ind then (
+      b.ind <- grow_i32 b.ind (b.num_nz + 1);
+      b.value <- grow_f b.value (b.num_nz + 1));
+    b.ind.{b.num_nz} <- Int32.of_int var;
+    b.value.{b.num_nz} <- coef;
+    b.marker.(var) <- b.num_nz;
+    b.num_nz <- b.num_nz + 1)
+
+(** [constant b c] adds constant [c] to the constraint being built *)
+let constant b c = b.constant <- b.constant +. c
+
+(** [terms b ~num ~ind ~value] adds [value.{k}] times variable [ind.{k}], for
+    [k] from [0] to [num - 1], to the constraint being built *)
+let terms b ~num ~ind ~value =
+  for k = 0 to num - 1 do
+    term b (Int32.to_int ind.{k}) value.{k}
+  done
+
+(** [flush b] adds the pending constraints to the model *)
+let flush b =
+  if b.row_first <> b.num_nz || b.constant <> 0.0 then
+    invalid_arg "Lin.flush: unfinished constraint";
+  if b.num_rows > 0 then (
+    let num = b.num_rows in
+    let matrix : Raw.compressed =
+      {
+        num_nz = b.num_nz;
+        xbeg = Array1.sub b.beg 0 num;
+        xind = Array1.sub b.ind 0 b.num_nz;
+        xval = Array1.sub b.value 0 b.num_nz;
+      }
+    in
+    let code =
+      Raw.add_constrs ~model:b.model ~num ~matrix:(Some matrix)
+        ~sense:(Array1.sub b.sense 0 num) ~rhs:(Array1.sub b.rhs 0 num)
+        ~name:None
+    in
+    (* the block is dropped even on failure, so that the builder stays
+       usable *)
+    b.num_rows <- 0;
+    b.num_nz <- 0;
+    b.row_first <- 0;
+    if code <> 0 then raise (Raw.Gurobi_error code);
+    b.added <- b.added + num)
+
+(** [row b sense rhs] finishes the constraint being built, as
+    [expression sense rhs], e.g. with [sense] [GRB.less_equal]. The constant
+    of the expression is moved to the right-hand side. *)
+let row b sense rhs =
+  (* drop the terms that cancelled out *)
+  let last = ref b.row_first in
+  for k = b.row_first to b.num_nz - 1 do
+    let v = b.value.{k} in
+    if v <> 0.0 then (
+      b.ind.{!last} <- b.ind.{k};
+      b.value.{!last} <- v;
+      incr last)
+  done;
+  b.num_nz <- !last;
+  let i = b.num_rows in
+  if i = Array1.dim b.beg then (
+    b.beg <- grow_i32 b.beg (i + 1);
+    b.sense <- grow_c b.sense (i + 1);
+    b.rhs <- grow_f b.rhs (i + 1));
+  b.beg.{i} <- Int32.of_int b.row_first;
+  b.sense.{i} <- sense;
+  b.rhs.{i} <- rhs -. b.constant;
+  b.num_rows <- i + 1;
+  b.row_first <- b.num_nz;
+  b.constant <- 0.0;
+  if b.num_nz >= b.chunk_nz then flush b
+
+(** [num_added b] is the number of constraints added to the model by [b] so
+    far, not counting those pending *)
+let num_added b = b.added
@@ -0,0 +1,97 @@
+(** Typed access to Gurobi log messages collected in a {!Raw.log_buffer} *)
+
+type progress = {
+  incumbent : float option;  (** objective of the best solution found *)
+  best_bound : float option;  (** best objective bound *)
+  gap : float option;  (** relative gap, in percent *)
+  elapsed : float;  (** seconds since the start of the optimization *)
+}
+(** a line of the MIP node log *)
+
+type summary = {
+  objective : float option;  (** best objective, if any *)
+  bound : float option;  (** best bound *)
+  final_gap : float option;  (** final relative gap, in percent *)
+}
+(** the [Best objective ...] line printed at the end of a MIP solve *)
+
+type line =
+  | Progress of progress
+  | Summary of summary
+  | Explored of float  (** seconds, from the [Explored ...] line *)
+  | Other of string  (** anything else, verbatim *)
+
+let tokens s = List.filter (fun t -> t <> "") (String.split_on_char ' ' s)
+
+let float_opt s = if s = "-" then None else float_of_string_opt s
+
+(* "12.5%" -> 12.5 *)
+let percent s =
+  let n = String.length s in
+  if n > 1 && s.[n - 1] = '%' then float_of_string_opt (String.sub s 0 (n - 1))
+  else None
+
+(* "3s" -> 3.0 *)
+let seconds s =
+  let n = String.length s in
+  if n > 1 && s.[n - 1] = 's' then float_of_string_opt (String.sub s 0 (n - 1))
+  else None
+
+(* strip a trailing comma, as in "5.0e+00," *)
+let uncomma s =
+  let n = String.length s in
+  if n > 0 && s.[n - 1] = ',' then String.sub s 0 (n - 1) else s
+
+(* node log lines end with: Incumbent BestBd Gap It/Node Time, where missing
+   values are printed as "-" *)
+let parse_progress rev_tokens =
+  match rev_tokens with
+  | time :: _it_node :: gap :: bound :: incumbent :: _ -> (
+      match seconds time with
+      | None -> None
+      | Some elapsed ->
+          let gap_value = percent gap in
+          if gap_value = None && not (gap = "-" && incumbent = "-") then None
+          else if incumbent <> "-" && float_opt incumbent = None then None
+          else
+            Some
+              {
+                incumbent = float_opt incumbent;
+                best_bound = float_opt bound;
+                gap = gap_value;
+                elapsed;
+              })
+  | _ -> None
+
+(** [parse line] classifies a single line of log *)
+let parse line =
+  match tokens line with
+  | "Best" :: "objective" :: obj :: "best" :: "bound" :: bnd :: "gap" :: gap :: _
+    ->
+      Summary
+        {
+          objective = float_opt (uncomma obj);
+          bound = float_opt (uncomma bnd);
+          final_gap = percent gap;
+        }
+  | "Explored" :: rest -> (
+      let rec find = function
+        | "in" :: t :: "seconds" :: _ -> float_of_string_opt t
+        | _ :: rest -> find rest
+        | [] -> None
+      in
+      match find rest with Some t -> Explored t | None -> Other line)
+  | toks -> (
+      match parse_progress (List.rev toks) with
+      | Some p -> Progress p
+      | None -> Other line)
+
+(** [drain ?max buf] removes up to [max] (default: all available) messages
+    from [buf], and returns their lines, parsed, oldest first *)
+let drain ?(max = max_int) buf =
+  Raw.log_buffer_drain buf ~max
+  |> Array.to_list
+  |> List.map (String.split_on_char '\n')
+  |> List.concat
+  |> List.filter (fun l -> String.trim l <> "")
+  |> List.map parse
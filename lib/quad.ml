@@ -0,0 +1,168 @@
+(** A builder of quadratic expressions, for objectives and constraints.
+
+    Quadratic terms are accumulated as triples into growable bigarrays. When
+    the expression is submitted, they are sorted and merged with
+    {!Sparse.coo_coalesce}, so that each pair of variables reaches Gurobi
+    once, as [(i, j)] with [i <= j], in a single call to
+    {!Raw.add_q_p_terms} or {!Raw.add_q_constr}. Linear terms of the same
+    variable are merged as they are added, as in {!Lin}. The builder is empty
+    again after each submission.
+
+    {[
+      let q = Quad.create model in
+      (* x0^2 + x0 x1 + x1 x0 + 2 x0 >= 1 *)
+      Quad.qterm q 0 0 1.0;
+      Quad.qterm q 0 1 1.0;
+      Quad.qterm q 1 0 1.0;
+      Quad.term q 0 2.0;
+      Quad.constr q GRB.greater_equal 1.0
+    ]}
+
+    Errors raise [Raw.Gurobi_error]. *)
+
+open Bigarray
+
+type t = {
+  model : Raw.model;
+  mutable q_row : Raw.i32a;
+  mutable q_col : Raw.i32a;
+  mutable q_val : Raw.fa;
+  mutable q_num : int;
+  mutable l_ind : Raw.i32a;
+  mutable l_val : Raw.fa;
+  mutable l_num : int;
+  mutable marker : int array;
+      (** [marker.(v)] is the position of variable [v] in [l_ind], if it is
+          below [l_num] and [l_ind] holds [v] there *)
+  mutable constant : float;
+}
+
+(** [create model] is an empty quadratic expression over the variables of
+    [model] *)
+let create model =
+  {
+    model;
+    q_row = Utils.i32a 4096;
+    q_col = Utils.i32a 4096;
+    q_val = Utils.fa 4096;
+    q_num = 0;
+    l_ind = Utils.i32a 1024;
+    l_val = Utils.fa 1024;
+    l_num = 0;
+    marker = Array.make 1024 (-1);
+    constant = 0.0;
+  }
+
+(** [qterm q i j coef] adds [coef] times variables [i] and [j] *)
+let qterm q i j coef =
+  if q.q_num = Array1.dim q.q_row then (
+    q.q_row <- Lin.grow_i32 q.q_row (q.q_num + 1);
+    q.q_col <- Lin.grow_i32 q.q_col (q.q_num + 1);
+    q.q_val <- Lin.grow_f q.q_val (q.q_num + 1));
+  q.q_row.{q.q_num} <- Int32.of_int i;
+  q.q_col.{q.q_num} <- Int32.of_int j;
+  q.q_val.{q.q_num} <- coef;
+  q.q_num <- q.q_num + 1
+
+(** [qterms q ~num ~row ~col ~value] adds [value.{k}] times variables
+    [row.{k}] and [col.{k}], for [k] from [0] to [num - 1] *)
+let qterms q ~num ~row ~col ~value =
+  let n = q.q_num + num in
+  if n > Array1.dim q.q_row then (
+    q.q_row <- Lin.grow_i32 q.q_row n;
+    q.q_col <- Lin.grow_i32 q.q_col n;
+    q.q_val <- Lin.grow_f q.q_val n);
+  Array1.blit (Array1.sub row 0 num) (Array1.sub q.q_row q.q_num num);
+  Array1.blit (Array1.sub col 0 num) (Array1.sub q.q_col q.q_num num);
+  Array1.blit (Array1.sub value 0 num) (Array1.sub q.q_val q.q_num num);
+  q.q_num <- n
+
+(** [term q var coef] adds [coef] times variable [var] *)
+let term q var coef =
+  if var < 0 then invalid_arg "Quad.term: var";
+  if var >= Array.length q.marker then (
+    let n = Array.length q.marker in
+    let marker = Array.make (max (var + 1) (2 * n)) (-1) in
+    Array.blit q.marker 0 marker 0 n;
+    q.marker <- marker);
+  let k = q.marker.(var) in
+  if k >= 0 && k < q.l_num && Int32.to_int q.l_ind.{k} = var then
+    q.l_val.{k} <- q.l_val.{k} +. coef
+  else (
+    if q.l_num = Array1.dim q.l_ind then (
+      q.l_ind <- Lin.grow_i32 q.l_ind (q.l_num + 1);
+      q.l_val <- Lin.grow_f q.l_val (q.l_num + 1));
+    q.l_ind.{q.l_num} <- Int32.of_int var;
+    q.l_val.{q.l_num} <- coef;
+    q.marker.(var) <- q.l_num;
+    q.l_num <- q.l_num + 1)
+
+(** [constant q c] adds constant [c] *)
+let constant q c = q.constant <- q.constant +. c
+
+(** [clear q] empties [q] *)
+let clear q =
+  q.q_num <- 0;
+  q.l_num <- 0;
+  q.constant <- 0.0
+
+(* merge the quadratic terms; the result is their number *)
+let coalesce q =
+  Sparse.coo_coalesce ~num:q.q_num ~row:q.q_row ~col:q.q_col ~value:q.q_val
+    ~symmetric:true
+
+let check q code =
+  if code <> 0 then (
+    clear q;
+    raise (Raw.Gurobi_error code))
+
+(** [objective q] adds [q] to the objective of its model: its quadratic
+    terms, the coefficients of its linear terms, and its constant are all
+    added to those already there. *)
+let objective q =
+  let model = q.model in
+  let num_qnz = coalesce q in
+  if num_qnz > 0 then
+    check q
+      (Raw.add_q_p_terms ~model ~num_qnz ~q_row:q.q_row ~q_col:q.q_col
+         ~q_val:q.q_val);
+  if q.l_num > 0 then (
+    let ind = Array1.sub q.l_ind 0 q.l_num in
+    let values = Utils.fa q.l_num in
+    check q
+      (Raw.get_float_attr_list ~model ~name:GRB.dbl_attr_obj ~num:q.l_num ~ind
+         ~values);
+    for k = 0 to q.l_num - 1 do
+      values.{k} <- values.{k} +. q.l_val.{k}
+    done;
+    check q
+      (Raw.set_float_attr_list ~model ~name:GRB.dbl_attr_obj ~num:q.l_num ~ind
+         ~values));
+  if q.constant <> 0.0 then (
+    match Raw.get_float_attr ~model ~name:GRB.dbl_attr_objcon with
+    | Error code -> check q code
+    | Ok objcon ->
+        check q
+          (Raw.set_float_attr ~model ~name:GRB.dbl_attr_objcon
+             ~value:(objcon +. q.constant)));
+  clear q
+
+(** [constr ?name q sense rhs] adds the quadratic constraint
+    [q sense rhs] to the model of [q], the constant of [q] being moved to the
+    right-hand side *)
+let constr ?name q sense rhs =
+  let q_num_nz = coalesce q in
+  let linear =
+    if q.l_num = 0 then None
+    else
+      Some
+        ( q.l_num,
+          Array1.sub q.l_ind 0 q.l_num,
+          Array1.sub q.l_val 0 q.l_num )
+  in
+  let code =
+    Raw.add_q_constr ~model:q.model ~linear ~q_num_nz ~q_row:q.q_row
+      ~q_col:q.q_col ~q_val:q.q_val ~sense ~rhs:(rhs -. q.constant) ~name
+  in
+  clear q;
+  if code <> 0 then raise (Raw.Gurobi_error code)
@@ -21,6 +21,20 @@ open Bigarray
 type fa = (float, float64_elt, c_layout) Array1.t
 type ca = (char, int8_unsigned_elt, c_layout) Array1.t
 type i32a = (int32, int32_elt, c_layout) Array1.t
+type i64a = (int64, int64_elt, c_layout) Array1.t
+
+type packed_names = {
+  data : ca;  (** the names, each terminated by ['\000'], back to back *)
+  offsets : i32a;  (** [offsets.{i}] is where name [i] begins in [data] *)
+}
+(** a table of names held in two bigarrays, rather than in as many OCaml
+    strings; see {!Utils.pack_names} *)
+
+exception Gurobi_error of int
+(** raised, with a Gurobi error code, by the few functions that cannot report
+    errors through their result *)
+
+let () = Callback.register_exception "guroobi.error" (Gurobi_error 0)
 
 type env
 (** Gurobi enviroment *)
@@ -30,6 +44,13 @@ type model
 
 external empty_env : unit -> (env, int) result = "gu_empty_env"
 
+external free_env : env -> unit = "gu_free_env"
+(** [free_env env] frees [env] now, rather than when it is garbage collected.
+    All the models created in [env] must have been freed with [free_model]
+    first, and [env] must not be in use by [start_env] or [read_model] on
+    another thread, or [Invalid_argument] is raised. Using [env] afterwards
+    raises [Invalid_argument]. *)
+
 external set_int_param : env:env -> name:string -> value:int -> int
   = "gu_set_int_param"
 
@@ -68,6 +89,8 @@ external get_float_model_param : env:env -> name:string -> (float, int) result
 
 external start_env : env -> int = "gu_start_env"
 
+external reset_params : env -> int = "gu_reset_params"
+
 external new_model :
   env:env ->
   name:string option ->
@@ -79,6 +102,18 @@ external new_model :
   var_name:string array option ->
   (model, int) result = "gu_new_model_bc" "gu_new_model"
 
+external new_model_packed :
+  env:env ->
+  name:string option ->
+  num_vars:int ->
+  objective:fa option ->
+  lower_bound:fa option ->
+  upper_bound:fa option ->
+  var_type:ca option ->
+  var_name:packed_names option ->
+  (model, int) result = "gu_new_model_packed_bc" "gu_new_model_packed"
+(** like [new_model], with packed variable names *)
+
 type read_model_result = FileNotFound | Ok of model | Error of int
 
 external read_model : env:env -> path:string -> read_model_result
@@ -87,12 +122,44 @@ external read_model : env:env -> path:string -> read_model_result
 external update_model : model:model -> int 
   = "gu_update_model"
 
+external free_model : model -> unit = "gu_free_model"
+(** [free_model model] frees [model] now, rather than when it is garbage
+    collected, which may be much later: the GC is only told an estimate of the
+    memory that Gurobi uses for a model, refreshed by [update_model] and
+    [optimize]. Using [model] afterwards raises [Invalid_argument], except for
+    the functions of {!Fast}, which return [GRB.error_null_argument]. Raises
+    [Invalid_argument] while [model] is in use by another thread, in one of
+    the calls that release the runtime lock ([optimize], [compute_iis],
+    [write], [feas_relax], [get_vars] and friends), or by an asynchronous
+    optimization that has not finished. A model keeps its environment
+    alive. *)
+
 external reset_model : model:model -> int 
   = "gu_reset_model"
 
 external copy_model : model:model -> model option 
   = "gu_copy_model"
 
+external set_deserialization_env : env -> unit = "gu_set_deserialization_env"
+(** Models can be marshaled, e.g. to send them to another process. Only their
+    linear part (constraint matrix, objective, bounds, types, senses,
+    right-hand sides and names) and their non-default parameters are
+    preserved, not their callbacks or log buffers. Unmarshaled models are
+    created in the environment given to [set_deserialization_env], which must
+    have been started; unmarshaling without one fails. Marshaling never
+    raises: a model that cannot be marshaled, e.g. one with quadratic parts,
+    fails when unmarshaled, with [Failure]. Check it first with
+    {!marshal_check}. *)
+
+external marshal_check : model -> int = "gu_marshal_check"
+(** [marshal_check model] is [0] if [model] can be marshaled, and
+    [GRB.error_not_supported] if it has quadratic terms or constraints, SOS
+    or general constraints, which marshaling would lose. *)
+
+external register_model_ops : unit -> unit = "gu_register_model_ops"
+
+let () = register_model_ops ()
+
 external set_float_attr_element :
   model:model -> name:string -> index:int -> value:float -> int
   = "gu_set_float_attr_element"
@@ -125,6 +192,42 @@ external get_int_attr_element :
   model:model -> name:string -> index:int -> (int, int) result
   = "gu_get_int_attr_element"
 
+(** The [*_attr_list] functions set or get an attribute for the [num]
+    elements whose indices are in [ind], in a single call. The getters write
+    the values into [values]. *)
+
+external set_float_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> values:fa -> int
+  = "gu_set_float_attr_list"
+
+external get_float_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> values:fa -> int
+  = "gu_get_float_attr_list"
+
+external set_int_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> values:i32a -> int
+  = "gu_set_int_attr_list"
+
+external get_int_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> values:i32a -> int
+  = "gu_get_int_attr_list"
+
+external set_char_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> values:ca -> int
+  = "gu_set_char_attr_list"
+
+external get_char_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> values:ca -> int
+  = "gu_get_char_attr_list"
+
+external set_str_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> values:string array -> int
+  = "gu_set_str_attr_list"
+
+external get_str_attr_list :
+  model:model -> name:string -> num:int -> ind:i32a -> (string array, int) result
+  = "gu_get_str_attr_list"
+
 external set_float_attr : model:model -> name:string -> value:float -> int
   = "gu_set_float_attr"
 
@@ -151,6 +254,17 @@ external get_float_attr_array :
   model:model -> name:string -> start:int -> len:int -> (fa, int) result
   = "gu_get_float_attr_array"
 
+external get_float_attr_array_into :
+  model:model ->
+  name:string ->
+  start:int ->
+  len:int ->
+  dst:fa ->
+  offset:int ->
+  int = "gu_get_float_attr_array_into_bc" "gu_get_float_attr_array_into"
+(** like [get_float_attr_array], but writes the [len] values into [dst],
+    starting at [dst.{offset}], instead of allocating a new array *)
+
 external set_int_attr_array :
   model:model -> name:string -> start:int -> len:int -> values:i32a -> int
   = "gu_set_int_attr_array"
@@ -159,6 +273,17 @@ external get_int_attr_array :
   mmodel:model -> name:string -> start:int -> len:int -> (i32a, int) result
   = "gu_get_int_attr_array"
 
+external get_int_attr_array_into :
+  model:model ->
+  name:string ->
+  start:int ->
+  len:int ->
+  dst:i32a ->
+  offset:int ->
+  int = "gu_get_int_attr_array_into_bc" "gu_get_int_attr_array_into"
+(** like [get_int_attr_array], but writes the [len] values into [dst],
+    starting at [dst.{offset}], instead of allocating a new array *)
+
 external set_char_attr_array :
   model:model -> name:string -> start:int -> len:int -> values:ca -> int
   = "gu_set_char_attr_array"
@@ -167,6 +292,17 @@ external get_char_attr_array :
   model:model -> name:string -> start:int -> len:int -> (ca, int) result
   = "gu_get_char_attr_array"
 
+external get_char_attr_array_into :
+  model:model ->
+  name:string ->
+  start:int ->
+  len:int ->
+  dst:ca ->
+  offset:int ->
+  int = "gu_get_char_attr_array_into_bc" "gu_get_char_attr_array_into"
+(** like [get_char_attr_array], but writes the [len] values into [dst],
+    starting at [dst.{offset}], instead of allocating a new array *)
+
 external get_str_attr_array :
   model:model ->
   name:string ->
@@ -174,6 +310,38 @@ external get_str_attr_array :
   len:int ->
   (string array, int) result = "gu_get_str_attr_array"
 
+external get_str_attr_array_packed :
+  model:model -> name:string -> start:int -> len:int ->
+  (packed_names, int) result = "gu_get_str_attr_array_packed"
+(** like [get_str_attr_array], e.g. for [VarName] or [ConstrName], but
+    returns the strings packed *)
+
+external set_mip_start :
+  model:model ->
+  start_number:int ->
+  num:int ->
+  ind:i32a option ->
+  values:fa ->
+  int = "gu_set_mip_start"
+(** [set_mip_start ~model ~start_number ~num ~ind ~values] fills MIP start
+    number [start_number] (that is, the [Start] attribute, with the
+    [StartNumber] parameter set to [start_number], then restored) in a single
+    call. When [ind] is [None], [values.{j}] is the start value of variable
+    [j], for [j] in [0 .. num-1]; otherwise [values.{k}] is the start value
+    of variable [ind.{k}]. Start values of other variables are left untouched; they are
+    undefined unless set previously, making for a partial start. The
+    [NumStart] attribute is increased if needed, which updates the model. *)
+
+type compressed64 = {
+  num_nz : int;  (** length of [xind] and [xval] *)
+  xbeg : i64a;
+  xind : i32a;
+  xval : fa;
+}
+(** like [compressed] below, but with 64-bit begin offsets, for more than [2^31]
+    nonzeros. Defined first, so that record expressions with these fields
+    default to [compressed]. *)
+
 type compressed = {
   num_nz : int;  (** length of [xind] and [xval] *)
   xbeg : i32a;
@@ -194,6 +362,26 @@ external add_constrs :
   name:string array option ->
   int = "gu_add_constrs_bc" "gu_add_constrs"
 
+external add_constrs_packed :
+  model:model ->
+  num:int ->
+  matrix:compressed option ->
+  sense:ca ->
+  rhs:fa ->
+  name:packed_names option ->
+  int = "gu_add_constrs_packed_bc" "gu_add_constrs_packed"
+(** like [add_constrs], with packed constraint names *)
+
+external add_constrs64 :
+  model:model ->
+  num:int ->
+  matrix:compressed64 option ->
+  sense:ca ->
+  rhs:fa ->
+  name:string array option ->
+  int = "gu_add_constrs64_bc" "gu_add_constrs64"
+(** like [add_constrs], through [GRBXaddconstrs] *)
+
 external del_constrs :
   model:model -> num_del:int -> ind:i32a -> int
   = "gu_del_constrs"
@@ -342,6 +530,18 @@ external add_vars :
   name:string array option ->
   int = "gu_add_vars_bc" "gu_add_vars"
 
+external add_vars_packed :
+  model:model ->
+  num_vars:int ->
+  matrix:compressed option ->
+  objective:fa option ->
+  lower_bound:fa option ->
+  upper_bound:fa option ->
+  var_type:ca option ->
+  name:packed_names option ->
+  int = "gu_add_vars_packed_bc" "gu_add_vars_packed"
+(** like [add_vars], with packed variable names *)
+
 external chg_coeffs :
   model:model ->
   num_chgs:int ->
@@ -350,6 +550,87 @@ external chg_coeffs :
   value:fa ->
   int = "gu_chg_coeffs"
 
+external add_vars64 :
+  model:model ->
+  num_vars:int ->
+  matrix:compressed64 option ->
+  objective:fa option ->
+  lower_bound:fa option ->
+  upper_bound:fa option ->
+  var_type:ca option ->
+  name:string array option ->
+  int = "gu_add_vars64_bc" "gu_add_vars64"
+(** like [add_vars], through [GRBXaddvars] *)
+
+external chg_coeffs64 :
+  model:model ->
+  num_chgs:int ->
+  c_ind:i32a ->
+  v_ind:i32a ->
+  value:fa ->
+  int = "gu_chg_coeffs64"
+(** like [chg_coeffs], through [GRBXchgcoeffs], for more than [2^31]
+    changes *)
+
+(** Reading the constraint matrix back, by constraints ([get_constrs]) or by
+    variables ([get_vars]), for the [len] of them starting at [start]. First,
+    [get_constrs_nz] or [get_vars_nz] gives the number of nonzeros, with
+    which to size [dst]: [dst.xbeg] must hold at least [len] elements, and
+    [dst.xind] and [dst.xval] at least [dst.num_nz]. The matrix is then
+    written in place, and its number of nonzeros returned. The [64] variants
+    are needed beyond [2^31] nonzeros. *)
+
+external get_constrs_nz :
+  model:model -> start:int -> len:int -> (int, int) result
+  = "gu_get_constrs_nz"
+
+external get_constrs :
+  model:model -> start:int -> len:int -> dst:compressed -> (int, int) result
+  = "gu_get_constrs"
+
+external get_constrs64 :
+  model:model -> start:int -> len:int -> dst:compressed64 -> (int, int) result
+  = "gu_get_constrs64"
+
+external get_vars_nz :
+  model:model -> start:int -> len:int -> (int, int) result = "gu_get_vars_nz"
+
+external get_vars :
+  model:model -> start:int -> len:int -> dst:compressed -> (int, int) result
+  = "gu_get_vars"
+
+external get_vars64 :
+  model:model -> start:int -> len:int -> dst:compressed64 -> (int, int) result
+  = "gu_get_vars64"
+
+external get_coeff :
+  model:model -> constr:int -> var:int -> (float, int) result = "gu_get_coeff"
+(** [get_coeff ~model ~constr ~var] is a single coefficient of the
+    constraint matrix *)
+
+external load_model :
+  env:env ->
+  name:string option ->
+  num_vars:int ->
+  num_constrs:int ->
+  obj_sense:int ->
+  obj_con:float ->
+  objective:fa option ->
+  sense:ca ->
+  rhs:fa ->
+  matrix:compressed64 ->
+  lower_bound:fa option ->
+  upper_bound:fa option ->
+  var_type:ca option ->
+  var_name:packed_names option ->
+  constr_name:packed_names option ->
+  (model, int) result = "gu_load_model_bc" "gu_load_model"
+(** [load_model] creates a complete model in a single call to
+    [GRBXloadmodel], which is cheaper than [new_model] followed by [add_vars]
+    and [add_constrs]. [matrix] holds the constraint matrix by columns, with
+    [matrix.xbeg] of length [num_vars]. [obj_sense] is [GRB.minimize] or
+    [GRB.maximize]. *)
+
 external add_q_p_terms :
   model:model ->
   num_qnz:int ->
@@ -358,10 +639,154 @@ external add_q_p_terms :
   q_val:fa ->
   int = "gu_add_q_p_terms"
 
+(** [optimize], [write], [compute_iis], [read_model] and [feas_relax] release
+    the OCaml runtime lock while Gurobi is working, so that other OCaml threads
+    can run in the meantime. It is the caller's responsibility not to use the
+    same model from another thread while one of these calls is in progress. *)
+
 external optimize : model -> int = "gu_optimize"
 external write : model:model -> path:string -> int = "gu_write"
 external compute_iis : model -> int = "gu_compute_iis"
 
+type log_buffer
+(** bounded in-memory buffer of Gurobi log messages *)
+
+external log_buffer_create : capacity:int -> log_buffer
+  = "gu_log_buffer_create"
+(** [log_buffer_create ~capacity] creates a log buffer able to hold about
+    [capacity] bytes of messages. Gurobi appends messages to it without ever
+    waiting for the OCaml runtime (concurrent appends are serialized by a
+    short spinlock, not the runtime lock); when it is full, new messages are
+    dropped. *)
+
+external set_log_buffer : env:env -> log_buffer option -> int
+  = "gu_set_log_buffer"
+(** [set_log_buffer ~env (Some buf)] directs the log messages of [env], and of
+    the models subsequently created from it, to [buf] (through
+    [GRBsetlogcallbackfuncenv]). This is independent of the [LogFile] and
+    [LogToConsole] parameters. [None] stops logging to a buffer. *)
+
+external set_model_log_buffer : model:model -> log_buffer option -> int
+  = "gu_set_model_log_buffer"
+(** [set_model_log_buffer ~model (Some buf)] directs the log messages of
+    [model] to [buf] (through [GRBsetlogcallbackfunc]) *)
+
+external log_buffer_drain : log_buffer -> max:int -> string array
+  = "gu_log_buffer_drain"
+(** [log_buffer_drain buf ~max] removes and returns up to [max] messages from
+    [buf], oldest first. A message may span several lines. See also
+    {!Log.drain}. *)
+
+external log_buffer_dropped : log_buffer -> int = "gu_log_buffer_dropped"
+(** number of messages dropped so far because [buf] was full *)
+
+type cb_context
+(** the context of a callback invocation, passed by Gurobi to callbacks. It
+    must not be used outside of the callback invocation to which it was
+    passed: the [cb_*] functions then raise [Invalid_argument]. *)
+
+external set_callback_func :
+  model:model ->
+  wheres:int list option ->
+  (cb_context -> where:int -> unit) option ->
+  int = "gu_set_callback_func"
+(** [set_callback_func ~model ~wheres (Some f)] registers [f] as the callback
+    of [model], replacing any previous one; [f ctx ~where] is then invoked
+    during optimization, where [where] is one of the [GRB.cb_*] where codes,
+    such as [GRB.cb_mip] or [GRB.cb_mipsol]. When [wheres] is [Some l], only
+    the where codes in [l] are passed on to [f], the others being filtered out
+    without entering OCaml. Passing [None] instead of [Some f] removes the
+    callback. An exception escaping from [f] terminates the optimization, and
+    is re-raised by [optimize] (or [compute_iis], [async_poll], [async_wait])
+    once it has stopped; later exceptions of the same optimization are
+    dropped.
+
+    The callback is held by the model, so it should not itself hold on to the
+    model, lest neither be collected until the callback is removed. *)
+
+external cb_get_float : cb_context -> what:int -> (float[@unboxed])
+  = "gu_cb_get_float_bc" "gu_cb_get_float"
+(** [cb_get_float ctx ~what] queries a [float]-valued piece of information,
+    such as [GRB.cb_mip_objbst] or [GRB.cb_runtime], without allocating. Raises
+    [Gurobi_error] on failure. *)
+
+external cb_get_int : cb_context -> what:int -> (int[@untagged])
+  = "gu_cb_get_int_bc" "gu_cb_get_int"
+(** [cb_get_int ctx ~what] queries an [int]-valued piece of information, such
+    as [GRB.cb_mip_solcnt], without allocating. Raises [Gurobi_error] on
+    failure. *)
+
+external cb_get_str : cb_context -> what:int -> (string, int) result
+  = "gu_cb_get_str"
+(** [cb_get_str ctx ~what] queries a [string]-valued piece of information,
+    such as [GRB.cb_msg_string] *)
+
+external cb_get_solution : cb_context -> what:int -> dst:fa -> int
+  = "gu_cb_get_solution"
+(** [cb_get_solution ctx ~what ~dst] writes a vector with one element per
+    variable, such as [GRB.cb_mipsol_sol] or [GRB.cb_mipnode_rel], into [dst],
+    which must be at least as long as the number of variables of the model. *)
+
+external cb_solution : cb_context -> solution:fa -> (float, int) result
+  = "gu_cb_solution"
+(** [cb_solution ctx ~solution] proposes [solution], which must have one
+    element per variable, as a new incumbent from a [GRB.cb_mipnode] callback
+    (or [GRB.cb_mip], [GRB.cb_mipsol]); elements set to [GRB.undefined] are
+    left for Gurobi to complete. On success, the result is the objective value
+    of the solution, or [GRB.infinity] if it was not (yet) accepted. *)
+
+external cb_lazy :
+  cb_context -> num:int -> matrix:compressed -> sense:ca -> rhs:fa -> int
+  = "gu_cb_lazy"
+(** [cb_lazy ctx ~num ~matrix ~sense ~rhs] adds [num] lazy constraints, in the
+    same compressed form as [add_constrs], from a [GRB.cb_mipsol] or
+    [GRB.cb_mipnode] callback. The whole batch is added in a single call, which
+    returns the first error encountered, if any. A malformed [matrix] raises
+    [Invalid_argument] before any constraint is added. *)
+
+external cb_cut :
+  cb_context -> num:int -> matrix:compressed -> sense:ca -> rhs:fa -> int
+  = "gu_cb_cut"
+(** [cb_cut ctx ~num ~matrix ~sense ~rhs] adds [num] user cuts, in the same
+    compressed form as [add_constrs], from a [GRB.cb_mipnode] callback *)
+
+external cb_terminate : cb_context -> unit = "gu_cb_terminate"
+(** [cb_terminate ctx] requests that the optimization stops as soon as
+    possible *)
+
+type async_solve
+(** handle on an optimization running on a separate native thread *)
+
+external optimize_async : model -> async_solve = "gu_optimize_async"
+(** [optimize_async model] starts optimizing [model] on a new native thread and
+    returns immediately. The model must not be used, other than through the
+    returned handle, until the optimization has completed; [free_model]
+    raises [Invalid_argument] until [async_poll] or [async_wait] has seen it
+    complete. If the handle is garbage collected while the optimization is
+    still running, the
+    optimization is terminated. May raise [Failure] if the thread cannot be
+    created. *)
+
+external async_poll : async_solve -> int option = "gu_async_poll"
+(** [async_poll solve] is [None] while the optimization is running, and
+    [Some error] once it has completed, where [error] is what [optimize] would
+    have returned. *)
+
+external async_wait : async_solve -> int = "gu_async_wait"
+(** [async_wait solve] blocks, without holding the OCaml runtime lock, until
+    the optimization has completed, and returns what [optimize] would have
+    returned. *)
+
+external async_cancel : async_solve -> unit = "gu_async_cancel"
+(** [async_cancel solve] requests that the optimization stops as soon as
+    possible, through [GRBterminate]; use [async_wait] to wait for it to stop.
+*)
+
+external async_fd : async_solve -> Unix.file_descr = "gu_async_fd"
+(** [async_fd solve] is a file descriptor that becomes readable once the
+    optimization has completed, and remains readable thereafter. It is owned by
+    the handle, and must not be read from or closed by the caller. *)
+
 external set_objective_n :
   model:model ->
   index:int ->
@@ -383,3 +808,82 @@ external set_pwl_obj :
   x:fa ->
   y:fa ->
   int = "gu_set_pwl_obj"
+
+(** Allocation-free versions of the scalar attribute accessors, for tight
+    loops. They neither allocate nor raise: setters return the Gurobi error
+    code, and getters store it in [err.{0}], leaving [err] untouched if it is
+    empty. A getter's result is meaningless when the error is not [0]. *)
+module Fast = struct
+  external get_float_attr_element :
+    model:model -> name:string -> index:(int[@untagged]) -> err:i32a ->
+    (float[@unboxed])
+    = "gu_fast_get_float_attr_element_bc" "gu_fast_get_float_attr_element"
+  [@@noalloc]
+
+  external set_float_attr_element :
+    model:model -> name:string -> index:(int[@untagged]) ->
+    value:(float[@unboxed]) -> (int[@untagged])
+    = "gu_fast_set_float_attr_element_bc" "gu_fast_set_float_attr_element"
+  [@@noalloc]
+
+  external get_int_attr_element :
+    model:model -> name:string -> index:(int[@untagged]) -> err:i32a ->
+    (int[@untagged])
+    = "gu_fast_get_int_attr_element_bc" "gu_fast_get_int_attr_element"
+  [@@noalloc]
+
+  external set_int_attr_element :
+    model:model -> name:string -> index:(int[@untagged]) ->
+    value:(int[@untagged]) -> (int[@untagged])
+    = "gu_fast_set_int_attr_element_bc" "gu_fast_set_int_attr_element"
+  [@@noalloc]
+
+  external get_char_attr_element :
+    model:model -> name:string -> index:(int[@untagged]) -> err:i32a -> char
+    = "gu_fast_get_char_attr_element_bc" "gu_fast_get_char_attr_element"
+  [@@noalloc]
+
+  external set_char_attr_element :
+    model:model -> name:string -> index:(int[@untagged]) -> value:char ->
+    (int[@untagged])
+    = "gu_fast_set_char_attr_element_bc" "gu_fast_set_char_attr_element"
+  [@@noalloc]
+
+  external get_float_attr :
+    model:model -> name:string -> err:i32a -> (float[@unboxed])
+    = "gu_fast_get_float_attr_bc" "gu_fast_get_float_attr"
+  [@@noalloc]
+
+  external set_float_attr :
+    model:model -> name:string -> value:(float[@unboxed]) -> (int[@untagged])
+    = "gu_fast_set_float_attr_bc" "gu_fast_set_float_attr"
+  [@@noalloc]
+
+  external get_int_attr :
+    model:model -> name:string -> err:i32a -> (int[@untagged])
+    = "gu_fast_get_int_attr_bc" "gu_fast_get_int_attr"
+  [@@noalloc]
+
+  external set_int_attr :
+    model:model -> name:string -> value:(int[@untagged]) -> (int[@untagged])
+    = "gu_fast_set_int_attr_bc" "gu_fast_set_int_attr"
+  [@@noalloc]
+end
+
+(** Opt-in instrumentation of the stubs: when enabled, each call to Gurobi is
+    counted, per stub and per attribute or parameter name, with its errors and
+    a histogram of its latencies; bucket [i] counts the calls of [2^i] to
+    [2^(i+1)] ns. It is also enabled at startup when the [GUROOBI_INSTRUMENT]
+    environment variable is set to anything but [""] or ["0"]. See
+    {!Instrument}. *)
+
+external instrument_enable : bool -> unit = "gu_instrument_enable" [@@noalloc]
+external instrument_enabled : unit -> bool = "gu_instrument_enabled" [@@noalloc]
+external instrument_reset : unit -> unit = "gu_instrument_reset"
+
+external instrument_snapshot :
+  unit -> (string * string * int * int * int * int * int array) array * int
+  = "gu_instrument_snapshot"
+(** an array of [(stub, name, calls, errors, total_ns, max_ns, histogram)],
+    and the number of calls not recorded, the table of stubs and names being
+    full *)
@@ -0,0 +1,276 @@
+(** Binary snapshots of (the linear part of) a model, for fast reloading.
+
+    A snapshot holds the constraint matrix by columns, the objective, bounds,
+    variable types, senses, right-hand sides and names of a model, each in a
+    section of the file laid out exactly as the corresponding bigarray. Opening
+    a snapshot maps these sections into memory with [Unix.map_file], and
+    {!load} passes the mapped bigarrays as they are to {!Raw.load_model}.
+    Models with quadratic terms, quadratic constraints, SOS or general
+    constraints are rejected; parameters are not saved. Snapshots use the byte
+    order of the machine that wrote them. *)
+
+open Bigarray
+open Raw
+
+type t = {
+  num_vars : int;
+  num_constrs : int;
+  obj_sense : int;
+  obj_con : float;
+  matrix : compressed64;  (** by columns *)
+  objective : fa;
+  lower_bound : fa;
+  upper_bound : fa;
+  var_type : ca;
+  sense : ca;
+  rhs : fa;
+  var_names : packed_names option;
+  constr_names : packed_names option;
+}
+
+(* "GUROOBI1", read as a little-endian int64 *)
+let magic = 0x3149424f4f525547L
+let header_words = 8
+let align8 n = (n + 7) land lnot 7
+
+type header = {
+  h_num_vars : int;
+  h_num_constrs : int;
+  h_num_nz : int;
+  h_obj_sense : int;
+  h_obj_con : float;
+  h_var_names_size : int;
+  h_constr_names_size : int;
+}
+
+type layout = {
+  vbeg : int;
+  vind : int;
+  vval : int;
+  obj : int;
+  lb : int;
+  ub : int;
+  vtype : int;
+  csense : int;
+  crhs : int;
+  var_offsets : int;
+  var_data : int;
+  constr_offsets : int;
+  constr_data : int;
+  size : int;
+}
+
+(* the position of each section, in bytes, each aligned on 8 bytes *)
+let layout h =
+  let pos = ref (8 * header_words) in
+  let next bytes =
+    let p = !pos in
+    pos := align8 (p + bytes);
+    p
+  in
+  let nv = h.h_num_vars and nc = h.h_num_constrs and nz = h.h_num_nz in
+  let vbeg = next (8 * nv) in
+  let vind = next (4 * nz) in
+  let vval = next (8 * nz) in
+  let obj = next (8 * nv) in
+  let lb = next (8 * nv) in
+  let ub = next (8 * nv) in
+  let vtype = next nv in
+  let csense = next nc in
+  let crhs = next (8 * nc) in
+  let var_offsets = next (4 * nv) in
+  let var_data = next h.h_var_names_size in
+  let constr_offsets = next (4 * nc) in
+  let constr_data = next h.h_constr_names_size in
+  {
+    vbeg;
+    vind;
+    vval;
+    obj;
+    lb;
+    ub;
+    vtype;
+    csense;
+    crhs;
+    var_offsets;
+    var_data;
+    constr_offsets;
+    constr_data;
+    size = !pos;
+  }
+
+let map fd ~shared kind pos n =
+  array1_of_genarray
+    (Unix.map_file fd ~pos:(Int64.of_int pos) kind c_layout shared [| n |])
+
+let ( let* ) = Result.bind
+let check code = if code = 0 then Ok () else Error code
+
+(* [Error GRB.error_not_supported] if [model] has parts that a snapshot
+   cannot hold *)
+let check_linear model =
+  let none name =
+    let* n = get_int_attr ~model ~name in
+    if n = 0 then Ok () else Error GRB.error_not_supported
+  in
+  let* () = none GRB.int_attr_numqnzs in
+  let* () = none GRB.int_attr_numqconstrs in
+  let* () = none GRB.int_attr_numsos in
+  none GRB.int_attr_numgenconstrs
+
+(** [save model path] writes a snapshot of [model] to file [path]. The result
+    is [Error GRB.error_not_supported] if [model] has quadratic terms,
+    quadratic constraints, SOS or general constraints, which a snapshot
+    cannot hold. *)
+let save model path =
+  let* () = check (update_model ~model) in
+  let* () = check_linear model in
+  let* nv = get_int_attr ~model ~name:GRB.int_attr_numvars in
+  let* nc = get_int_attr ~model ~name:GRB.int_attr_numconstrs in
+  let* obj_sense = get_int_attr ~model ~name:GRB.int_attr_modelsense in
+  let* obj_con = get_float_attr ~model ~name:GRB.dbl_attr_objcon in
+  let* nz = get_vars_nz ~model ~start:0 ~len:nv in
+  let names name len =
+    if len = 0 then Ok None
+    else
+      let* names = get_str_attr_array_packed ~model ~name ~start:0 ~len in
+      Ok (Some names)
+  in
+  let* var_names = names GRB.str_attr_varname nv in
+  let* constr_names = names GRB.str_attr_constrname nc in
+  let names_size = function None -> 0 | Some n -> Array1.dim n.data in
+  let h =
+    {
+      h_num_vars = nv;
+      h_num_constrs = nc;
+      h_num_nz = nz;
+      h_obj_sense = obj_sense;
+      h_obj_con = obj_con;
+      h_var_names_size = names_size var_names;
+      h_constr_names_size = names_size constr_names;
+    }
+  in
+  let l = layout h in
+  let fd = Unix.openfile path [ Unix.O_RDWR; O_CREAT; O_TRUNC ] 0o644 in
+  Fun.protect
+    ~finally:(fun () -> Unix.close fd)
+    (fun () ->
+      let map kind pos n = map fd ~shared:true kind pos n in
+      let header = map int64 0 header_words in
+      (* mapping the last section extends the file to its full size *)
+      ignore (map char (l.size - 1) 1);
+      let matrix : compressed64 =
+        {
+          num_nz = nz;
+          xbeg = map int64 l.vbeg nv;
+          xind = map int32 l.vind nz;
+          xval = map float64 l.vval nz;
+        }
+      in
+      let* _ = get_vars64 ~model ~start:0 ~len:nv ~dst:matrix in
+      let float_array name pos len =
+        if len = 0 then Ok ()
+        else
+          check
+            (get_float_attr_array_into ~model ~name ~start:0 ~len
+               ~dst:(map float64 pos len) ~offset:0)
+      in
+      let char_array name pos len =
+        if len = 0 then Ok ()
+        else
+          check
+            (get_char_attr_array_into ~model ~name ~start:0 ~len
+               ~dst:(map char pos len) ~offset:0)
+      in
+      let* () = float_array GRB.dbl_attr_obj l.obj nv in
+      let* () = float_array GRB.dbl_attr_lb l.lb nv in
+      let* () = float_array GRB.dbl_attr_ub l.ub nv in
+      let* () = char_array GRB.char_attr_vtype l.vtype nv in
+      let* () = char_array GRB.char_attr_sense l.csense nc in
+      let* () = float_array GRB.dbl_attr_rhs l.crhs nc in
+      let blit_names names offsets_pos data_pos len =
+        match names with
+        | None -> ()
+        | Some { data; offsets } ->
+            Array1.blit offsets (map int32 offsets_pos len);
+            Array1.blit data (map char data_pos (Array1.dim data))
+      in
+      blit_names var_names l.var_offsets l.var_data nv;
+      blit_names constr_names l.constr_offsets l.constr_data nc;
+      (* the header last, so that an incomplete file is not recognized *)
+      header.{1} <- Int64.of_int nv;
+      header.{2} <- Int64.of_int nc;
+      header.{3} <- Int64.of_int nz;
+      header.{4} <- Int64.of_int obj_sense;
+      header.{5} <- Int64.bits_of_float obj_con;
+      header.{6} <- Int64.of_int h.h_var_names_size;
+      header.{7} <- Int64.of_int h.h_constr_names_size;
+      header.{0} <- magic;
+      Ok ())
+
+(** [open_file path] maps the snapshot in file [path] into memory. Raises
+    [Failure] if [path] is not a snapshot. *)
+let open_file path =
+  let fd = Unix.openfile path [ Unix.O_RDONLY ] 0 in
+  Fun.protect
+    ~finally:(fun () -> Unix.close fd)
+    (fun () ->
+      let map kind pos n = map fd ~shared:false kind pos n in
+      if (Unix.fstat fd).Unix.st_size < 8 * header_words then
+        failwith (path ^ ": not a snapshot");
+      let header = map int64 0 header_words in
+      if header.{0} <> magic then failwith (path ^ ": not a snapshot");
+      let h =
+        {
+          h_num_vars = Int64.to_int header.{1};
+          h_num_constrs = Int64.to_int header.{2};
+          h_num_nz = Int64.to_int header.{3};
+          h_obj_sense = Int64.to_int header.{4};
+          h_obj_con = Int64.float_of_bits header.{5};
+          h_var_names_size = Int64.to_int header.{6};
+          h_constr_names_size = Int64.to_int header.{7};
+        }
+      in
+      let l = layout h in
+      if (Unix.fstat fd).Unix.st_size < l.size then
+        failwith (path ^ ": truncated snapshot");
+      let nv = h.h_num_vars and nc = h.h_num_constrs and nz = h.h_num_nz in
+      let names offsets_pos data_pos len size =
+        if size = 0 then None
+        else
+          Some
+            { data = map char data_pos size; offsets = map int32 offsets_pos len }
+      in
+      {
+        num_vars = nv;
+        num_constrs = nc;
+        obj_sense = h.h_obj_sense;
+        obj_con = h.h_obj_con;
+        matrix =
+          {
+            num_nz = nz;
+            xbeg = map int64 l.vbeg nv;
+            xind = map int32 l.vind nz;
+            xval = map float64 l.vval nz;
+          };
+        objective = map float64 l.obj nv;
+        lower_bound = map float64 l.lb nv;
+        upper_bound = map float64 l.ub nv;
+        var_type = map char l.vtype nv;
+        sense = map char l.csense nc;
+        rhs = map float64 l.crhs nc;
+        var_names = names l.var_offsets l.var_data nv h.h_var_names_size;
+        constr_names =
+          names l.constr_offsets l.constr_data nc h.h_constr_names_size;
+      })
+
+(** [load ~env ?name s] creates a model from snapshot [s] *)
+let load ~env ?name s =
+  load_model ~env ~name ~num_vars:s.num_vars ~num_constrs:s.num_constrs
+    ~obj_sense:s.obj_sense ~obj_con:s.obj_con ~objective:(Some s.objective)
+    ~sense:s.sense ~rhs:s.rhs ~matrix:s.matrix ~lower_bound:(Some s.lower_bound)
+    ~upper_bound:(Some s.upper_bound) ~var_type:(Some s.var_type)
+    ~var_name:s.var_names ~constr_name:s.constr_names
+
+(** [read ~env ?name path] is [load ~env ?name (open_file path)] *)
+let read ~env ?name path = load ~env ?name (open_file path)
@@ -0,0 +1,93 @@
+(** Sparse matrix kernels, in C, that work on bigarrays in place *)
+
+external coo_coalesce :
+  num:int -> row:Raw.i32a -> col:Raw.i32a -> value:Raw.fa -> symmetric:bool ->
+  int = "gu_coo_coalesce"
+(** [coo_coalesce ~num ~row ~col ~value ~symmetric] sorts the first [num]
+    triples [(row.{k}, col.{k}, value.{k})] by row, then by column, and merges
+    those of the same row and column by adding up their values. Triples whose
+    values add up to zero are dropped. When [symmetric] holds, [(i, j)] and
+    [(j, i)] are the same element, which is stored with [i <= j], as Gurobi
+    expects of quadratic terms. The result is the number of triples left at
+    the start of the arrays. The sort is a radix sort, which releases the
+    runtime lock on large inputs. Raises [Invalid_argument] if an index is
+    negative. *)
+
+external coo_to_compressed :
+  threads:int ->
+  num_major:int ->
+  num_minor:int ->
+  num:int ->
+  major:Raw.i32a ->
+  minor:Raw.i32a ->
+  value:Raw.fa ->
+  merge:bool ->
+  beg:('a, 'b, Bigarray.c_layout) Bigarray.Array1.t ->
+  ind:Raw.i32a ->
+  xval:Raw.fa ->
+  int = "gu_coo_to_compressed_bc" "gu_coo_to_compressed"
+(** [coo_to_compressed ~threads ~num_major ~num_minor ~num ~major ~minor
+    ~value ~merge ~beg ~ind ~xval] sorts the first [num] triples
+    [(major.{k}, minor.{k}, value.{k})] by major index into [beg] (an [i32a]
+    or an [i64a] of length [num_major]), [ind] and [xval], which must have
+    room for [num] entries. The sort is stable. When [merge] holds, the
+    entries of each major index are also sorted by minor index, and those of
+    the same minor index are added up. The result is the number of entries
+    written to [ind] and [xval]. [threads] threads are used (all the cores,
+    when [threads <= 0]), and the runtime lock is released meanwhile. Raises
+    [Invalid_argument] if an index is out of range, or if [beg] has any other
+    kind of element. *)
+
+let compress ~threads ~merge ~num_major ~num_minor ~num ~major ~minor ~value
+    beg =
+  let ind = Utils.i32a num and xval = Utils.fa num in
+  let num_nz =
+    coo_to_compressed ~threads ~num_major ~num_minor ~num ~major ~minor ~value
+      ~merge ~beg ~ind ~xval
+  in
+  let sub a = Bigarray.Array1.sub a 0 num_nz in
+  (num_nz, sub ind, sub xval)
+
+(** [to_csr ?threads ?merge ~num_rows ~num_cols ~num ~row ~col ~value] is the
+    matrix of the [num] triples [(row.{k}, col.{k}, value.{k})] by rows, as
+    taken by {!Raw.add_constrs}, built with [coo_to_compressed]. [threads]
+    defaults to all the cores, and [merge] to [false]. *)
+let to_csr ?(threads = 0) ?(merge = false) ~num_rows ~num_cols ~num ~row ~col
+    ~value () : Raw.compressed =
+  let xbeg = Utils.i32a num_rows in
+  let num_nz, xind, xval =
+    compress ~threads ~merge ~num_major:num_rows ~num_minor:num_cols ~num
+      ~major:row ~minor:col ~value xbeg
+  in
+  { num_nz; xbeg; xind; xval }
+
+(** [to_csc ...] is like [to_csr ...], by columns, as taken by
+    {!Raw.add_vars} and {!Raw.load_model} *)
+let to_csc ?(threads = 0) ?(merge = false) ~num_rows ~num_cols ~num ~row ~col
+    ~value () : Raw.compressed =
+  let xbeg = Utils.i32a num_cols in
+  let num_nz, xind, xval =
+    compress ~threads ~merge ~num_major:num_cols ~num_minor:num_rows ~num
+      ~major:col ~minor:row ~value xbeg
+  in
+  { num_nz; xbeg; xind; xval }
+
+(** [to_csr64 ...] is like [to_csr ...], with 64-bit offsets *)
+let to_csr64 ?(threads = 0) ?(merge = false) ~num_rows ~num_cols ~num ~row
+    ~col ~value () : Raw.compressed64 =
+  let xbeg = Utils.i64a num_rows in
+  let num_nz, xind, xval =
+    compress ~threads ~merge ~num_major:num_rows ~num_minor:num_cols ~num
+      ~major:row ~minor:col ~value xbeg
+  in
+  { num_nz; xbeg; xind; xval }
+
+(** [to_csc64 ...] is like [to_csc ...], with 64-bit offsets *)
+let to_csc64 ?(threads = 0) ?(merge = false) ~num_rows ~num_cols ~num ~row
+    ~col ~value () : Raw.compressed64 =
+  let xbeg = Utils.i64a num_cols in
+  let num_nz, xind, xval =
+    compress ~threads ~merge ~num_major:num_cols ~num_minor:num_rows ~num
+      ~major:col ~minor:row ~value xbeg
+  in
+  { num_nz; xbeg; xind; xval }
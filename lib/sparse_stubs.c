@@ -0,0 +1,637 @@
+#define CAML_NAME_SPACE
+
+/* OCaml's C FFI */
+#include <caml/mlvalues.h>
+#include <caml/memory.h>
+#include <caml/alloc.h>
+#include <caml/fail.h>
+#include <caml/threads.h>
+#include <caml/bigarray.h>
+
+/* standard C */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// sparse matrix kernels that do not involve Gurobi, operating on
+// bigarrays in place
+
+// below this many elements, the runtime lock is kept
+#define GU_SPARSE_BLOCKING_MIN 4096
+
+static void* get_ba( value a, int kind, long min_n ) {
+  struct caml_ba_array* ba = Caml_ba_array_val(a);
+  if ( ba->num_dims == 1 &&
+       (ba->flags & CAML_BA_KIND_MASK) == kind &&
+       ba->dim[0] >= min_n ) {
+    return ba->data;
+  }
+  else {
+    return NULL;
+  }
+}
+
+// least significant digit first radix sort of keys[0..n-1], moving
+// vals along; digits are RADIX_BITS wide, so that the counts of a
+// pass fit in the L1 cache
+#define RADIX_BITS 11
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+static bool radix_sort( long n, uint64_t* keys, double* vals, int key_bits )
+{
+  int passes = (key_bits + RADIX_BITS - 1) / RADIX_BITS;
+  if ( passes == 0 ) {
+    return true;
+  }
+  size_t (*counts)[RADIX_SIZE] = calloc( passes, sizeof(*counts) );
+  uint64_t* keys2 = malloc( n * sizeof(uint64_t) );
+  double* vals2 = malloc( n * sizeof(double) );
+  if ( counts == NULL || keys2 == NULL || vals2 == NULL ) {
+    free( counts );
+    free( keys2 );
+    free( vals2 );
+    return false;
+  }
+
+  // the histograms of all the passes, in a single read of the keys
+  for (long k = 0; k < n; k++) {
+    uint64_t key = keys[k];
+    for (int p = 0; p < passes; p++) {
+      counts[p][(key >> (p * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+    }
+  }
+
+  uint64_t* src_k = keys;
+  double* src_v = vals;
+  uint64_t* dst_k = keys2;
+  double* dst_v = vals2;
+  for (int p = 0; p < passes; p++) {
+    int shift = p * RADIX_BITS;
+    // a digit shared by all the keys leaves their order unchanged
+    if ( counts[p][(src_k[0] >> shift) & (RADIX_SIZE - 1)] == (size_t)n ) {
+      continue;
+    }
+    size_t pos = 0;
+    for (int d = 0; d < RADIX_SIZE; d++) {
+      size_t c = counts[p][d];
+      counts[p][d] = pos;
+      pos += c;
+    }
+    for (long k = 0; k < n; k++) {
+      size_t i = counts[p][(src_k[k] >> shift) & (RADIX_SIZE - 1)]++;
+      dst_k[i] = src_k[k];
+      dst_v[i] = src_v[k];
+    }
+    uint64_t* tk = src_k; src_k = dst_k; dst_k = tk;
+    double* tv = src_v; src_v = dst_v; dst_v = tv;
+  }
+
+  if ( src_k != keys ) {
+    memcpy( keys, src_k, n * sizeof(uint64_t) );
+    memcpy( vals, src_v, n * sizeof(double) );
+  }
+  free( counts );
+  free( keys2 );
+  free( vals2 );
+  return true;
+}
+
+static int bit_width( uint64_t x )
+{
+  return x == 0 ? 0 : 64 - __builtin_clzll( x );
+}
+
+// sort the triples (row[k], col[k], val[k]), for k < n, by row and
+// then by column, and merge those with the same row and column,
+// dropping zeros. When symmetric, (i, j) and (j, i) are the same
+// element, stored with i <= j. Returns the number of triples left, or
+// -1 if an index is negative, or -2 if memory is short.
+static long coo_coalesce( long n, int* row, int* col, double* val, bool symmetric )
+{
+  if ( n == 0 ) {
+    return 0;
+  }
+  uint64_t max_row = 0, max_col = 0;
+  for (long k = 0; k < n; k++) {
+    if ( row[k] < 0 || col[k] < 0 ) {
+      return -1;
+    }
+    if ( symmetric && row[k] > col[k] ) {
+      int t = row[k]; row[k] = col[k]; col[k] = t;
+    }
+    if ( (uint64_t)row[k] > max_row ) max_row = row[k];
+    if ( (uint64_t)col[k] > max_col ) max_col = col[k];
+  }
+
+  // keys as compact as the indices allow, to save passes
+  uint64_t width = max_col + 1;
+  uint64_t* keys = malloc( n * sizeof(uint64_t) );
+  if ( keys == NULL ) {
+    return -2;
+  }
+  bool sorted = true;
+  for (long k = 0; k < n; k++) {
+    keys[k] = (uint64_t)row[k] * width + (uint64_t)col[k];
+    if ( k > 0 && keys[k] < keys[k-1] ) {
+      sorted = false;
+    }
+  }
+  int key_bits = bit_width( max_row * width + max_col );
+  if ( !sorted && !radix_sort( n, keys, val, key_bits ) ) {
+    free( keys );
+    return -2;
+  }
+
+  long m = 0;
+  for (long k = 0; k < n; ) {
+    uint64_t key = keys[k];
+    double sum = 0.0;
+    for (; k < n && keys[k] == key; k++) {
+      sum += val[k];
+    }
+    if ( sum != 0.0 ) {
+      row[m] = (int)(key / width);
+      col[m] = (int)(key % width);
+      val[m] = sum;
+      m++;
+    }
+  }
+  free( keys );
+  return m;
+}
+
+CAMLprim value gu_coo_coalesce(
+ value v_num,
+ value v_row,
+ value v_col,
+ value v_val,
+ value v_symmetric
+)
+{
+  CAMLparam5( v_num, v_row, v_col, v_val, v_symmetric );
+  long n = Long_val( v_num );
+  if ( n < 0 ) {
+    caml_invalid_argument( "coo_coalesce:num" );
+  }
+  int* row = get_ba( v_row, CAML_BA_INT32, n );
+  if ( row == NULL ) {
+    caml_invalid_argument( "coo_coalesce:row" );
+  }
+  int* col = get_ba( v_col, CAML_BA_INT32, n );
+  if ( col == NULL ) {
+    caml_invalid_argument( "coo_coalesce:col" );
+  }
+  double* val = get_ba( v_val, CAML_BA_FLOAT64, n );
+  if ( val == NULL ) {
+    caml_invalid_argument( "coo_coalesce:val" );
+  }
+
+  bool blocking = n >= GU_SPARSE_BLOCKING_MIN;
+  if ( blocking ) {
+    caml_enter_blocking_section();
+  }
+  long m = coo_coalesce( n, row, col, val, Bool_val( v_symmetric ) );
+  if ( blocking ) {
+    caml_leave_blocking_section();
+  }
+
+  if ( m == -1 ) {
+    caml_invalid_argument( "coo_coalesce:index" );
+  }
+  if ( m == -2 ) {
+    caml_raise_out_of_memory();
+  }
+  CAMLreturn( Val_long( m ) );
+}
+
+// COO to compressed (CSR or CSC) assembly, with a parallel stable
+// counting sort. The entries are sorted by their major index (the row
+// for CSR, the column for CSC); when duplicates are merged, they are
+// first sorted by their minor index, so that the entries of each major
+// index end up sorted, and each sum is taken in the same order on
+// every run.
+
+// below this many entries, a single thread is used
+#define GU_SPARSE_PARALLEL_MIN (1 << 16)
+
+struct count_sort {
+  long n;
+  int threads;
+  const int* key;     // sorted by, in [0, num_keys)
+  long num_keys;
+  const int* other;   // moved along
+  long num_other;     // if >= 0, other is checked to be in [0, num_other)
+  const double* val;  // moved along
+  int* out_key;       // may be NULL
+  int* out_other;
+  double* out_val;
+  size_t* hist;       // threads * num_keys; counts, then positions
+  atomic_bool bad;    // a key, or a checked other, is out of range
+};
+
+struct count_task {
+  struct count_sort* s;
+  int t;
+};
+
+static long chunk_begin( long n, int threads, int t )
+{
+  return (long)((double)n * t / threads);
+}
+
+static void* count_keys( void* arg )
+{
+  struct count_task* task = arg;
+  struct count_sort* s = task->s;
+  size_t* hist = s->hist + (size_t)task->t * s->num_keys;
+  long end = chunk_begin( s->n, s->threads, task->t + 1 );
+  for (long k = chunk_begin( s->n, s->threads, task->t ); k < end; k++) {
+    int key = s->key[k];
+    if ( key < 0 || key >= s->num_keys ||
+         (s->num_other >= 0 && (s->other[k] < 0 || s->other[k] >= s->num_other)) ) {
+      atomic_store( &s->bad, true );
+      return NULL;
+    }
+    hist[key]++;
+  }
+  return NULL;
+}
+
+static void* scatter_keys( void* arg )
+{
+  struct count_task* task = arg;
+  struct count_sort* s = task->s;
+  size_t* pos = s->hist + (size_t)task->t * s->num_keys;
+  long end = chunk_begin( s->n, s->threads, task->t + 1 );
+  for (long k = chunk_begin( s->n, s->threads, task->t ); k < end; k++) {
+    size_t i = pos[s->key[k]]++;
+    if ( s->out_key != NULL ) {
+      s->out_key[i] = s->key[k];
+    }
+    s->out_other[i] = s->other[k];
+    s->out_val[i] = s->val[k];
+  }
+  return NULL;
+}
+
+// run f on each of tasks[0..threads-1], in parallel; a task whose
+// thread cannot be created runs on the calling thread
+static void run_tasks( int threads, void* (*f)(void*), void* tasks, size_t task_size )
+{
+  pthread_t* ids = malloc( threads * sizeof(pthread_t) );
+  bool* started = calloc( threads, sizeof(bool) );
+  if ( ids == NULL || started == NULL ) {
+    free( ids );
+    free( started );
+    for (int t = 0; t < threads; t++) {
+      f( (char*)tasks + t * task_size );
+    }
+    return;
+  }
+  for (int t = 1; t < threads; t++) {
+    void* task = (char*)tasks + t * task_size;
+    started[t] = pthread_create( &ids[t], NULL, f, task ) == 0;
+    if ( !started[t] ) {
+      f( task );
+    }
+  }
+  f( tasks );
+  for (int t = 1; t < threads; t++) {
+    if ( started[t] ) {
+      pthread_join( ids[t], NULL );
+    }
+  }
+  free( ids );
+  free( started );
+}
+
+// stable sort by key; key_begin[k], for k <= num_keys, is set to the
+// position of the first entry whose key is k (key_begin[num_keys] = n).
+// Returns 0, or -1 if a key is out of range, or -2 if memory is short.
+static int count_sort( struct count_sort* s, long* key_begin )
+{
+  // one histogram per thread, and no more histogram entries than
+  // entries to sort
+  long max_threads = s->n / (s->num_keys > 0 ? s->num_keys : 1);
+  if ( s->n < GU_SPARSE_PARALLEL_MIN || max_threads < 1 ) {
+    s->threads = 1;
+  }
+  else if ( s->threads > max_threads ) {
+    s->threads = (int)max_threads;
+  }
+  s->hist = calloc( (size_t)s->threads * s->num_keys, sizeof(size_t) );
+  struct count_task* tasks = malloc( s->threads * sizeof(struct count_task) );
+  if ( (s->hist == NULL && s->num_keys > 0) || tasks == NULL ) {
+    free( s->hist );
+    free( tasks );
+    return -2;
+  }
+  for (int t = 0; t < s->threads; t++) {
+    tasks[t].s = s;
+    tasks[t].t = t;
+  }
+  atomic_init( &s->bad, false );
+
+  run_tasks( s->threads, count_keys, tasks, sizeof(struct count_task) );
+  if ( atomic_load( &s->bad ) ) {
+    free( s->hist );
+    free( tasks );
+    return -1;
+  }
+
+  // the entries of key k from chunk t follow those of the earlier
+  // chunks, which keeps the sort stable
+  size_t pos = 0;
+  for (long k = 0; k < s->num_keys; k++) {
+    key_begin[k] = pos;
+    for (int t = 0; t < s->threads; t++) {
+      size_t* h = &s->hist[(size_t)t * s->num_keys + k];
+      size_t c = *h;
+      *h = pos;
+      pos += c;
+    }
+  }
+  key_begin[s->num_keys] = pos;
+
+  run_tasks( s->threads, scatter_keys, tasks, sizeof(struct count_task) );
+  free( s->hist );
+  free( tasks );
+  return 0;
+}
+
+struct merge_task {
+  long first;           // major indices [first, last)
+  long last;
+  const long* begin;    // of each major index, in ind and val
+  const int* ind;
+  const double* val;
+  long* merged;         // number of entries of each major index, merged
+  int* out_ind;
+  double* out_val;
+};
+
+// count the distinct minor indices of each major index; the minor
+// indices of each major index are sorted
+static void* merge_count( void* arg )
+{
+  struct merge_task* task = arg;
+  for (long m = task->first; m < task->last; m++) {
+    long c = 0;
+    for (long k = task->begin[m]; k < task->begin[m+1]; k++) {
+      if ( k == task->begin[m] || task->ind[k] != task->ind[k-1] ) {
+        c++;
+      }
+    }
+    task->merged[m] = c;
+  }
+  return NULL;
+}
+
+// after merge_count, merged holds the position of the merged entries
+// of each major index
+static void* merge_write( void* arg )
+{
+  struct merge_task* task = arg;
+  for (long m = task->first; m < task->last; m++) {
+    long i = task->merged[m] - 1;
+    for (long k = task->begin[m]; k < task->begin[m+1]; k++) {
+      if ( k == task->begin[m] || task->ind[k] != task->ind[k-1] ) {
+        i++;
+        task->out_ind[i] = task->ind[k];
+        task->out_val[i] = task->val[k];
+      }
+      else {
+        task->out_val[i] += task->val[k];
+      }
+    }
+  }
+  return NULL;
+}
+
+// merge the entries of the same major and minor indices, from (begin,
+// ind, val) into (out_ind, out_val); begin is updated. Returns the
+// number of entries left, or -2 if memory is short.
+static long merge_duplicates( int threads, long num_major, long* begin,
+                              const int* ind, const double* val,
+                              int* out_ind, double* out_val )
+{
+  long n = begin[num_major];
+  if ( n < GU_SPARSE_PARALLEL_MIN ) {
+    threads = 1;
+  }
+  long* merged = malloc( (num_major + 1) * sizeof(long) );
+  struct merge_task* tasks = malloc( threads * sizeof(struct merge_task) );
+  if ( merged == NULL || tasks == NULL ) {
+    free( merged );
+    free( tasks );
+    return -2;
+  }
+  // ranges of major indices with about as many entries each
+  long m = 0;
+  for (int t = 0; t < threads; t++) {
+    long target = chunk_begin( n, threads, t + 1 );
+    long first = m;
+    while ( m < num_major && (t == threads - 1 || begin[m+1] <= target) ) {
+      m++;
+    }
+    tasks[t] = (struct merge_task){ first, m, begin, ind, val, merged, out_ind, out_val };
+  }
+
+  run_tasks( threads, merge_count, tasks, sizeof(struct merge_task) );
+  long pos = 0;
+  for (long i = 0; i < num_major; i++) {
+    long c = merged[i];
+    merged[i] = pos;
+    pos += c;
+  }
+  run_tasks( threads, merge_write, tasks, sizeof(struct merge_task) );
+
+  memcpy( begin, merged, num_major * sizeof(long) );
+  begin[num_major] = pos;
+  free( merged );
+  free( tasks );
+  return pos;
+}
+
+// (num_major + 1) positions, then the work arrays of the merge
+struct assembly {
+  long* begin;
+  int* minor_a;
+  int* major_a;
+  double* val_a;
+  int* ind_b;
+  double* val_b;
+};
+
+static void free_assembly( struct assembly* a )
+{
+  free( a->begin );
+  free( a->minor_a );
+  free( a->major_a );
+  free( a->val_a );
+  free( a->ind_b );
+  free( a->val_b );
+}
+
+// returns the number of entries of the result, or -1 if an index is
+// out of range, or -2 if memory is short
+static long coo_to_compressed( int threads, long num_major, long num_minor, long n,
+                               const int* major, const int* minor, const double* val,
+                               bool merge, int* out_ind, double* out_val,
+                               struct assembly* a )
+{
+  a->begin = malloc( (num_major + 1) * sizeof(long) );
+  if ( a->begin == NULL ) {
+    return -2;
+  }
+  if ( !merge ) {
+    struct count_sort by_major = {
+      .n = n, .threads = threads, .key = major, .num_keys = num_major,
+      .other = minor, .num_other = num_minor, .val = val,
+      .out_key = NULL, .out_other = out_ind, .out_val = out_val
+    };
+    int error = count_sort( &by_major, a->begin );
+    return error != 0 ? error : n;
+  }
+
+  a->minor_a = malloc( n * sizeof(int) );
+  a->major_a = malloc( n * sizeof(int) );
+  a->val_a = malloc( n * sizeof(double) );
+  a->ind_b = malloc( n * sizeof(int) );
+  a->val_b = malloc( n * sizeof(double) );
+  long* minor_begin = malloc( (num_minor + 1) * sizeof(long) );
+  if ( minor_begin == NULL ||
+       (n > 0 && (a->minor_a == NULL || a->major_a == NULL || a->val_a == NULL ||
+                  a->ind_b == NULL || a->val_b == NULL)) ) {
+    free( minor_begin );
+    return -2;
+  }
+  struct count_sort by_minor = {
+    .n = n, .threads = threads, .key = minor, .num_keys = num_minor,
+    .other = major, .num_other = -1, .val = val,
+    .out_key = a->minor_a, .out_other = a->major_a, .out_val = a->val_a
+  };
+  int error = count_sort( &by_minor, minor_begin );
+  free( minor_begin );
+  if ( error != 0 ) {
+    return error;
+  }
+  struct count_sort by_major = {
+    .n = n, .threads = threads, .key = a->major_a, .num_keys = num_major,
+    .other = a->minor_a, .num_other = -1, .val = a->val_a,
+    .out_key = NULL, .out_other = a->ind_b, .out_val = a->val_b
+  };
+  error = count_sort( &by_major, a->begin );
+  if ( error != 0 ) {
+    return error;
+  }
+  return merge_duplicates( threads, num_major, a->begin, a->ind_b, a->val_b,
+                           out_ind, out_val );
+}
+
+CAMLprim value gu_coo_to_compressed(
+ value v_threads,
+ value v_num_major,
+ value v_num_minor,
+ value v_num,
+ value v_major,
+ value v_minor,
+ value v_val,
+ value v_merge,
+ value v_beg,
+ value v_ind,
+ value v_out_val
+)
+{
+  CAMLparam5( v_threads, v_num_major, v_num_minor, v_num, v_major );
+  CAMLxparam5( v_minor, v_val, v_merge, v_beg, v_ind );
+  CAMLxparam1( v_out_val );
+
+  int threads = Int_val( v_threads );
+  if ( threads <= 0 ) {
+    long online = sysconf( _SC_NPROCESSORS_ONLN );
+    threads = online > 0 ? (int)online : 1;
+  }
+  long num_major = Long_val( v_num_major );
+  long num_minor = Long_val( v_num_minor );
+  long n = Long_val( v_num );
+  if ( num_major < 0 || num_minor < 0 || n < 0 ) {
+    caml_invalid_argument( "coo_to_compressed:num" );
+  }
+  const int* major = get_ba( v_major, CAML_BA_INT32, n );
+  if ( major == NULL ) {
+    caml_invalid_argument( "coo_to_compressed:major" );
+  }
+  const int* minor = get_ba( v_minor, CAML_BA_INT32, n );
+  if ( minor == NULL ) {
+    caml_invalid_argument( "coo_to_compressed:minor" );
+  }
+  const double* val = get_ba( v_val, CAML_BA_FLOAT64, n );
+  if ( val == NULL ) {
+    caml_invalid_argument( "coo_to_compressed:val" );
+  }
+  int32_t* beg32 = get_ba( v_beg, CAML_BA_INT32, num_major );
+  int64_t* beg64 = get_ba( v_beg, CAML_BA_INT64, num_major );
+  if ( beg32 == NULL && beg64 == NULL ) {
+    caml_invalid_argument( "coo_to_compressed:beg" );
+  }
+  if ( beg32 != NULL && n > INT32_MAX ) {
+    caml_invalid_argument( "coo_to_compressed:beg" );
+  }
+  int* out_ind = get_ba( v_ind, CAML_BA_INT32, n );
+  if ( out_ind == NULL ) {
+    caml_invalid_argument( "coo_to_compressed:ind" );
+  }
+  double* out_val = get_ba( v_out_val, CAML_BA_FLOAT64, n );
+  if ( out_val == NULL ) {
+    caml_invalid_argument( "coo_to_compressed:out_val" );
+  }
+
+  struct assembly a = { NULL, NULL, NULL, NULL, NULL, NULL };
+  caml_enter_blocking_section();
+  long nz = coo_to_compressed( threads, num_major, num_minor, n, major, minor, val,
+                               Bool_val( v_merge ), out_ind, out_val, &a );
+  if ( nz >= 0 ) {
+    for (long m = 0; m < num_major; m++) {
+      if ( beg32 != NULL ) {
+        beg32[m] = (int32_t)a.begin[m];
+      }
+      else {
+        beg64[m] = a.begin[m];
+      }
+    }
+  }
+  free_assembly( &a );
+  caml_leave_blocking_section();
+
+  if ( nz == -1 ) {
+    caml_invalid_argument( "coo_to_compressed:index" );
+  }
+  if ( nz == -2 ) {
+    caml_raise_out_of_memory();
+  }
+  CAMLreturn( Val_long( nz ) );
+}
+
+CAMLprim value gu_coo_to_compressed_bc(value* v_args, int arg_n )
+{
+  assert( arg_n == 11 );
+  return gu_coo_to_compressed(
+			      v_args[0],
+			      v_args[1],
+			      v_args[2],
+			      v_args[3],
+			      v_args[4],
+			      v_args[5],
+			      v_args[6],
+			      v_args[7],
+			      v_args[8],
+			      v_args[9],
+			      v_args[10]
+			      );
+}
@@ -0,0 +1,180 @@
+(** A cache of base models, from which requests get clones with their own
+    bounds, right-hand sides or objective coefficients.
+
+    Each template is a fully updated base model, registered under a name and a
+    version. {!acquire} hands out a copy of it (made with {!Raw.copy_model}),
+    with the changes of the request applied in bulk with
+    {!Raw.set_float_attr_list}. {!release} puts the changed values back to
+    those of the base model, resets the copy with {!Raw.reset_model}, and keeps
+    it for a later request, rather than copying the base model again. All
+    functions can be called from several threads.
+
+    Only the attributes of the deltas are restored, so users of a clone may
+    change nothing else. Clones whose number of variables or constraints
+    differs from the base model are freed on release, but other changes
+    (e.g. to attributes not in the deltas) would be seen by later requests. *)
+
+open Raw
+
+type delta = {
+  attr : string;  (** a [float] attribute, e.g. [GRB.dbl_attr_rhs] *)
+  ind : i32a;  (** indices of the elements to change *)
+  values : fa;  (** their values, one per element of [ind] *)
+}
+(** a change of some elements of an attribute of the base model *)
+
+type template = {
+  version : int;
+  base : model;
+  num_vars : int;
+  num_constrs : int;
+  mutable idle : model list;  (** released clones *)
+  mutable num_idle : int;
+  mutable retired : bool;  (** replaced by a newer version *)
+}
+
+type t = {
+  mutex : Mutex.t;
+  max_idle : int;
+  templates : (string, template) Hashtbl.t;
+}
+
+type clone = {
+  model : model;
+  template : template;
+  restore : delta list;  (** values of the base model, for [release] *)
+}
+(** a copy of a base model, with the changes of a request *)
+
+let check code = if code <> 0 then raise (Gurobi_error code)
+
+let get_int model name =
+  match get_int_attr ~model ~name with
+  | Ok n -> n
+  | Error code -> raise (Gurobi_error code)
+
+let locked t f =
+  Mutex.lock t.mutex;
+  Fun.protect ~finally:(fun () -> Mutex.unlock t.mutex) f
+
+(** [create ?max_idle ()] is an empty cache, which keeps at most [max_idle]
+    (default: 16) released clones per template *)
+let create ?(max_idle = 16) () =
+  { mutex = Mutex.create (); max_idle; templates = Hashtbl.create 8 }
+
+let retire template =
+  template.retired <- true;
+  List.iter free_model template.idle;
+  template.idle <- [];
+  template.num_idle <- 0
+
+(** [register t ~name ~version model] makes [model] the base model of
+    template [name], replacing any version older than [version]. [model] is
+    updated, and must not be modified afterwards. Raises [Invalid_argument] if
+    a version at least as recent is already registered. *)
+let register t ~name ~version model =
+  check (update_model ~model);
+  let num_vars = get_int model GRB.int_attr_numvars in
+  let num_constrs = get_int model GRB.int_attr_numconstrs in
+  locked t (fun () ->
+      (match Hashtbl.find_opt t.templates name with
+      | Some old when old.version >= version ->
+          invalid_arg "Template_cache.register: version"
+      | Some old -> retire old
+      | None -> ());
+      Hashtbl.replace t.templates name
+        {
+          version;
+          base = model;
+          num_vars;
+          num_constrs;
+          idle = [];
+          num_idle = 0;
+          retired = false;
+        })
+
+(** [version t ~name] is the version of template [name], if registered *)
+let version t ~name =
+  locked t (fun () ->
+      Option.map (fun tp -> tp.version) (Hashtbl.find_opt t.templates name))
+
+(** [remove t ~name] forgets template [name], and frees its idle clones *)
+let remove t ~name =
+  locked t (fun () ->
+      Option.iter retire (Hashtbl.find_opt t.templates name);
+      Hashtbl.remove t.templates name)
+
+let num d = Bigarray.Array1.dim d.ind
+
+(* the values of the base model for the elements changed by [d] *)
+let base_values base d =
+  let values = Utils.fa (num d) in
+  check
+    (get_float_attr_list ~model:base ~name:d.attr ~num:(num d) ~ind:d.ind
+       ~values);
+  { d with values }
+
+let apply model deltas =
+  List.iter
+    (fun d ->
+      check
+        (set_float_attr_list ~model ~name:d.attr ~num:(num d) ~ind:d.ind
+           ~values:d.values))
+    deltas
+
+(** [acquire t ~name deltas] is a copy of the base model of template [name],
+    with the changes [deltas] applied (in order). Raises [Not_found] if no
+    such template is registered, and [Gurobi_error] on failure. *)
+let acquire t ~name deltas =
+  let template, model, restore =
+    locked t (fun () ->
+        let template = Hashtbl.find t.templates name in
+        (* Gurobi models are not thread-safe, so the base model is only read
+           under the lock *)
+        let restore = List.map (base_values template.base) deltas in
+        match template.idle with
+        | model :: rest ->
+            template.idle <- rest;
+            template.num_idle <- template.num_idle - 1;
+            (template, model, restore)
+        | [] -> (
+            match copy_model ~model:template.base with
+            | Some model -> (template, model, restore)
+            | None -> raise (Gurobi_error GRB.error_out_of_memory)))
+  in
+  (try apply model deltas
+   with e ->
+     free_model model;
+     raise e);
+  { model; template; restore }
+
+(** [release t clone] gives [clone] back to the cache, once its model is no
+    longer used. The model is freed instead if its template was replaced or
+    removed, if enough clones are idle, if it cannot be reset, or if variables
+    or constraints were added to or removed from it. *)
+let release t { model; template; restore } =
+  let reusable =
+    try
+      apply model restore;
+      reset_model ~model = 0
+      && update_model ~model = 0
+      && get_int model GRB.int_attr_numvars = template.num_vars
+      && get_int model GRB.int_attr_numconstrs = template.num_constrs
+    with Gurobi_error _ -> false
+  in
+  let keep =
+    reusable
+    && locked t (fun () ->
+           if template.retired || template.num_idle >= t.max_idle then false
+           else (
+             template.idle <- model :: template.idle;
+             template.num_idle <- template.num_idle + 1;
+             true))
+  in
+  if not keep then free_model model
+
+(** [with_clone t ~name deltas f] is [f model], for the model of a clone
+    acquired for the duration of the call *)
+let with_clone t ~name deltas f =
+  let clone = acquire t ~name deltas in
+  Fun.protect ~finally:(fun () -> release t clone) (fun () -> f clone.model)
@@ -36,6 +36,49 @@ let to_i32a arr =
   done;
   i32a_arr
 
+(** [i64a n] creates an [i64a] bigarray whose length is [n] *)
+let i64a n = Array1.create int64 c_layout n
+
+(** [to_i64a arr] creates an [i64a] bigarray from int array [arr] *)
+let to_i64a arr =
+  let n = Array.length arr in
+  let i64a_arr = i64a n in
+  for i = 0 to n - 1 do
+    i64a_arr.{i} <- Int64.of_int arr.(i)
+  done;
+  i64a_arr
+
 (** [string_of_error code] returns a string representation of the error [code],
     if known, and [None] otherwise *)
 let string_of_error code = List.assoc_opt code GRB.code_error_msg_assoc
+
+(** [pack_names names] packs [names] into a single pair of bigarrays *)
+let pack_names names =
+  let n = Array.length names in
+  let size = Array.fold_left (fun acc s -> acc + String.length s + 1) 0 names in
+  let data = ca (max size 1) in
+  let offsets = i32a n in
+  data.{0} <- '\000';
+  let pos = ref 0 in
+  Array.iteri
+    (fun i s ->
+      offsets.{i} <- Int32.of_int !pos;
+      String.iteri (fun j c -> data.{!pos + j} <- c) s;
+      pos := !pos + String.length s;
+      data.{!pos} <- '\000';
+      incr pos)
+    names;
+  { Raw.data; offsets }
+
+(** [packed_name names i] is the [i]-th name of [names] *)
+let packed_name { Raw.data; offsets } i =
+  let start = Int32.to_int offsets.{i} in
+  let stop = ref start in
+  while data.{!stop} <> '\000' do
+    incr stop
+  done;
+  String.init (!stop - start) (fun j -> data.{start + j})
+
+(** [unpack_names names] is the array of the names in [names] *)
+let unpack_names names =
+  Array.init (Array1.dim names.Raw.offsets) (packed_name names)
@@ -0,0 +1,64 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Build and change a small LP through a batch of changes. Not one of
+   Gurobi's examples. *)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"batch.log");
+      az (start_env env);
+
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:(Some "batch") ~num_vars:2 ~objective:None
+             ~lower_bound:None
+             ~upper_bound:(Some (to_fa [| 3.0; 3.0 |]))
+             ~var_type:None ~var_name:None)
+      in
+      az
+        (set_int_attr ~model ~name:GRB.int_attr_modelsense ~value:GRB.maximize);
+      let b = Batch.create model in
+
+      (* maximize x + 2 y subject to x + y <= 4, x - y <= 1, x <= 2, y <= 3 *)
+      Batch.add_constr b ~num_nz:2 ~var_index:(to_i32a [| 0; 1 |])
+        ~nz:(to_fa [| 1.0; 1.0 |]) ~sense:GRB.less_equal ~rhs:4.0
+        ~name:(Some "c0");
+      Batch.add_constr b ~num_nz:2 ~var_index:(to_i32a [| 0; 1 |])
+        ~nz:(to_fa [| 1.0; -1.0 |]) ~sense:GRB.less_equal ~rhs:1.0 ~name:None;
+      Batch.set_float_attr_element b ~name:GRB.dbl_attr_ub ~index:0 ~value:1.0;
+      Batch.set_float_attr_element b ~name:GRB.dbl_attr_ub ~index:0 ~value:2.0;
+      Batch.set_float_attr_element b ~name:GRB.dbl_attr_obj ~index:0 ~value:1.0;
+      Batch.set_float_attr_element b ~name:GRB.dbl_attr_obj ~index:1 ~value:2.0;
+      az (Batch.optimize b);
+
+      let report () =
+        let obj =
+          eer "get_float_attr" (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+        in
+        let num_constrs =
+          eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numconstrs)
+        in
+        let name =
+          eer "get_str_attr_element"
+            (get_str_attr_element ~model ~name:GRB.str_attr_constrname ~index:0)
+        in
+        pr "%d constraints, first %s, objective %g\n" num_constrs name obj
+      in
+      report ();
+
+      (* x + 2 y <= 4, x - y <= 0 *)
+      Batch.chg_coeff b ~constr:0 ~var:1 ~value:2.0;
+      Batch.set_float_attr_element b ~name:GRB.dbl_attr_rhs ~index:1 ~value:0.0;
+      az (Batch.optimize b);
+      report ()
+
+let () = main ()
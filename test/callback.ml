@@ -0,0 +1,172 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* This example reads a model from a file, sets up a callback that monitors
+   optimization progress and implements a custom termination strategy, and
+   outputs progress information to a log file.
+
+   The termination strategy implemented in this callback stops the
+   optimization of a MIP model once at least one of the following two
+   conditions have been satisfied: 1) the optimality gap is less than 10%, or
+   2) at least 10000 nodes have been explored, and an integer feasible solution
+   has been found. Note that termination is normally handled through Gurobi
+   parameters (MIPGap, NodeLimit, etc.). You should only use a callback for
+   termination if the available parameters don't capture your desired
+   termination criterion. *)
+
+type callback_data = {
+  mutable last_iter : float;
+  mutable last_node : float;
+  solution : fa;
+  log : out_channel;
+}
+
+let mycallback data ctx ~where =
+  let lpr fmt = Printf.fprintf data.log fmt in
+  if where = GRB.cb_polling then (* Ignore polling callback *) ()
+  else if where = GRB.cb_presolve then (
+    (* Presolve callback *)
+    let cdels = cb_get_int ctx ~what:GRB.cb_pre_coldel in
+    let rdels = cb_get_int ctx ~what:GRB.cb_pre_rowdel in
+    if cdels <> 0 || rdels <> 0 then
+      lpr "%7d columns and %7d rows are removed\n" cdels rdels)
+  else if where = GRB.cb_simplex then (
+    (* Simplex callback *)
+    let itcnt = cb_get_float ctx ~what:GRB.cb_spx_itrcnt in
+    if itcnt -. data.last_iter >= 100.0 then (
+      data.last_iter <- itcnt;
+      let obj = cb_get_float ctx ~what:GRB.cb_spx_objval in
+      let ispert = cb_get_int ctx ~what:GRB.cb_spx_ispert in
+      let pinf = cb_get_float ctx ~what:GRB.cb_spx_priminf in
+      let dinf = cb_get_float ctx ~what:GRB.cb_spx_dualinf in
+      let ch = if ispert = 0 then ' ' else if ispert = 1 then 'S' else 'P' in
+      lpr "%7.0f %14.7e%c %13.6e %13.6e\n" itcnt obj ch pinf dinf))
+  else if where = GRB.cb_mip then (
+    (* General MIP callback *)
+    let nodecnt = cb_get_float ctx ~what:GRB.cb_mip_nodcnt in
+    let objbst = cb_get_float ctx ~what:GRB.cb_mip_objbst in
+    let objbnd = cb_get_float ctx ~what:GRB.cb_mip_objbnd in
+    let solcnt = cb_get_int ctx ~what:GRB.cb_mip_solcnt in
+    if nodecnt -. data.last_node >= 100.0 then (
+      data.last_node <- nodecnt;
+      let actnodes = cb_get_float ctx ~what:GRB.cb_mip_nodlft in
+      let itcnt = cb_get_float ctx ~what:GRB.cb_mip_itrcnt in
+      let cutcnt = cb_get_int ctx ~what:GRB.cb_mip_cutcnt in
+      lpr "%7.0f %7.0f %8.0f %13.6e %13.6e %7d %7d\n" nodecnt actnodes itcnt
+        objbst objbnd solcnt cutcnt);
+    if Float.abs (objbst -. objbnd) < 0.1 *. (1.0 +. Float.abs objbst) then (
+      lpr "Stop early - 10%% gap achieved\n";
+      cb_terminate ctx);
+    if nodecnt >= 10000.0 && solcnt > 0 then (
+      lpr "Stop early - 10000 nodes explored\n";
+      cb_terminate ctx))
+  else if where = GRB.cb_mipsol then (
+    (* MIP solution callback *)
+    let nodecnt = cb_get_float ctx ~what:GRB.cb_mipsol_nodcnt in
+    let obj = cb_get_float ctx ~what:GRB.cb_mipsol_obj in
+    let solcnt = cb_get_int ctx ~what:GRB.cb_mipsol_solcnt in
+    az (cb_get_solution ctx ~what:GRB.cb_mipsol_sol ~dst:data.solution);
+    lpr "**** New solution at node %.0f, obj %g, sol %d, x[0] = %.2f ****\n"
+      nodecnt obj solcnt data.solution.{0})
+  else if where = GRB.cb_mipnode then (
+    (* MIP node callback *)
+    lpr "**** New node ****\n";
+    let status = cb_get_int ctx ~what:GRB.cb_mipnode_status in
+    if status = GRB.optimal then (
+      az (cb_get_solution ctx ~what:GRB.cb_mipnode_rel ~dst:data.solution);
+      ignore (cb_solution ctx ~solution:data.solution)))
+  else if where = GRB.cb_barrier then (
+    (* Barrier callback *)
+    let itcnt = cb_get_int ctx ~what:GRB.cb_barrier_itrcnt in
+    let primobj = cb_get_float ctx ~what:GRB.cb_barrier_primobj in
+    let dualobj = cb_get_float ctx ~what:GRB.cb_barrier_dualobj in
+    let priminf = cb_get_float ctx ~what:GRB.cb_barrier_priminf in
+    let dualinf = cb_get_float ctx ~what:GRB.cb_barrier_dualinf in
+    let cmpl = cb_get_float ctx ~what:GRB.cb_barrier_compl in
+    lpr "%7d %14.7e %14.7e %13.6e %13.6e %13.6e\n" itcnt primobj dualobj
+      priminf dualinf cmpl)
+  else if where = GRB.cb_message then
+    (* Message callback *)
+    let msg = eer "cb_get_str" (cb_get_str ctx ~what:GRB.cb_msg_string) in
+    lpr "%s" msg
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      (* Turn off display and heuristics *)
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_float_param ~env ~name:GRB.dbl_par_heuristics ~value:0.0);
+      az (start_env env);
+
+      (* Read model from file *)
+      let model =
+        eer "read_model"
+          (match read_model ~env ~path:"data/stein9.mps" with
+          | FileNotFound ->
+              pr "Error: unable to open input file\n";
+              exit 1
+          | Ok m -> Ok m
+          | Error code -> Error code)
+      in
+
+      (* Allocate space for solution *)
+      let num_vars = eer "get_int_attr" (get_int_attr ~model ~name:"NumVars") in
+
+      (* Create a callback object and associate it with the model *)
+      let log = open_out "callback.log" in
+      let data =
+        { last_iter = -.GRB.infinity; last_node = -.GRB.infinity;
+          solution = fa num_vars; log }
+      in
+      az (set_callback_func ~model ~wheres:None (Some (mycallback data)));
+
+      (* Solve model and capture solution information *)
+      az (optimize model);
+      az (set_callback_func ~model ~wheres:None None);
+      close_out log;
+
+      pr "\nOptimization complete\n";
+      let sol_count =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_solcount)
+      in
+      let status =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_status)
+      in
+      (if sol_count = 0 then
+         pr "No solution found, optimization status = %d\n" status
+       else
+         let obj_val =
+           eer "get_float_attr"
+             (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+         in
+         pr "Solution found, objective = %.4e\n" obj_val);
+
+      (* Not in Gurobi's example: an exception escaping the callback is
+         re-raised by optimize, and the context cannot be used afterwards *)
+      let escaped = ref None in
+      az (reset_model ~model);
+      az
+        (set_callback_func ~model ~wheres:None
+           (Some
+              (fun ctx ~where:_ ->
+                escaped := Some ctx;
+                raise Exit)));
+      (match optimize model with
+      | _ -> pr "callback exception lost\n"
+      | exception Exit -> pr "callback exception re-raised\n");
+      az (set_callback_func ~model ~wheres:None None);
+      match !escaped with
+      | None -> pr "callback not called\n"
+      | Some ctx -> (
+          match cb_get_int ctx ~what:GRB.cb_mip_solcnt with
+          | _ -> pr "context used outside its callback\n"
+          | exception Invalid_argument _ ->
+              pr "context rejected outside its callback\n")
+
+let () = main ()
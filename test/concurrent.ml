@@ -0,0 +1,129 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* This test checks that [optimize] does not hold the OCaml runtime lock while
+   Gurobi is solving: a second thread keeps incrementing a counter, and we
+   verify that the counter moved while the main thread was inside [optimize].
+
+   The model is a market split instance, which is notoriously hard for branch
+   and bound; a time limit keeps the solve short but non-trivial:
+
+   minimize sum_i (s+_i + s-_i) subject to sum_j a_ij x_j + s+_i - s-_i = d_i,
+   x binary, s+ and s- non-negative *)
+
+let num_rows = 4
+let num_cols = 30
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"concurrent.log");
+      az (set_float_param ~env ~name:GRB.dbl_par_timelimit ~value:1.0);
+      az (start_env env);
+
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:(Some "concurrent") ~num_vars:0 ~objective:None
+             ~lower_bound:None ~upper_bound:None ~var_type:None ~var_name:None)
+      in
+
+      (* x_j, followed by s+_i and s-_i *)
+      let num_vars = num_cols + (2 * num_rows) in
+      let obj = fa num_vars in
+      let var_type = ca num_vars in
+      for j = 0 to num_vars - 1 do
+        if j < num_cols then (
+          obj.{j} <- 0.0;
+          var_type.{j} <- GRB.binary)
+        else (
+          obj.{j} <- 1.0;
+          var_type.{j} <- GRB.continuous)
+      done;
+      az
+        (add_vars ~model ~num_vars ~matrix:None ~objective:(Some obj)
+           ~lower_bound:None ~upper_bound:None ~var_type:(Some var_type)
+           ~name:None);
+
+      (* deterministic pseudo-random coefficients in [0, 99] *)
+      let seed = ref 12345 in
+      let next () =
+        seed := ((!seed * 1103515245) + 12345) land 0x7fffffff;
+        (!seed lsr 16) mod 100
+      in
+      let row_len = num_cols + 2 in
+      let num_nz = num_rows * row_len in
+      let xbeg = i32a num_rows in
+      let xind = i32a num_nz in
+      let xval = fa num_nz in
+      let sense = ca num_rows in
+      let rhs = fa num_rows in
+      for i = 0 to num_rows - 1 do
+        let b = i * row_len in
+        xbeg.{i} <- Int32.of_int b;
+        let sum = ref 0 in
+        for j = 0 to num_cols - 1 do
+          let a = next () in
+          sum := !sum + a;
+          xind.{b + j} <- Int32.of_int j;
+          xval.{b + j} <- float a
+        done;
+        xind.{b + num_cols} <- Int32.of_int (num_cols + (2 * i));
+        xval.{b + num_cols} <- 1.0;
+        xind.{b + num_cols + 1} <- Int32.of_int (num_cols + (2 * i) + 1);
+        xval.{b + num_cols + 1} <- -1.0;
+        sense.{i} <- GRB.equal;
+        rhs.{i} <- float (!sum / 2)
+      done;
+      az
+        (add_constrs ~model ~num:num_rows
+           ~matrix:(Some { num_nz; xbeg; xind; xval })
+           ~sense ~rhs ~name:None);
+
+      let ticks = ref 0 in
+      let running = ref true in
+      let ticker =
+        Thread.create
+          (fun () ->
+            while !running do
+              incr ticks;
+              Thread.yield ()
+            done)
+          ()
+      in
+      let before = !ticks in
+      az (optimize model);
+      let during = !ticks - before in
+      running := false;
+      Thread.join ticker;
+      pr "second thread progressed during optimize: %b\n" (during > 0);
+
+      (* Same model, solved asynchronously this time, without a time limit:
+         cancel it, and check that completion is signalled on the handle's file
+         descriptor *)
+      az (reset_model ~model);
+      az
+        (set_float_model_param ~model ~name:GRB.dbl_par_timelimit
+           ~value:GRB.infinity);
+      let solve = optimize_async model in
+      pr "free_model refused during the solve: %b\n"
+        (match free_model model with
+        | () -> false
+        | exception Invalid_argument _ -> true);
+      let fd = async_fd solve in
+      let _ = Unix.select [ fd ] [] [] 0.1 in
+      async_cancel solve;
+      let error = async_wait solve in
+      let ready, _, _ = Unix.select [ fd ] [] [] 0.0 in
+      pr "async solve completed: %b\n" (error = 0 && async_poll solve = Some 0);
+      pr "completion signalled on descriptor: %b\n" (ready = [ fd ]);
+      free_model model;
+      pr "model freed once the solve completed\n"
+
+let () = main ()
@@ -0,0 +1,69 @@
+open Guroobi
+open Raw
+open U
+
+(* Hand out environments from a pool of one, and check that their parameters
+   are reset when they are given back, and how a failing baseline is handled.
+   Not one of Gurobi's examples. *)
+
+(* raised by the baseline, after the first call, in the second part *)
+let failure = ref None
+
+let baseline env =
+  (match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () -> ());
+  az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+  az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"env_pool.log");
+  match !failure with Some e -> raise e | None -> ()
+
+let seed env = eer "get_int_param" (get_int_param ~env ~name:GRB.int_par_seed)
+
+(* dropped environments are freed right away, which releases their license
+   seat *)
+let freed env =
+  match get_int_param ~env ~name:GRB.int_par_seed with
+  | _ -> false
+  | exception Invalid_argument _ -> true
+
+let main () =
+  let pool = Env_pool.create ~baseline ~size:1 () in
+
+  let env = Env_pool.acquire pool in
+  let initial = seed env in
+  az (set_int_param ~env ~name:GRB.int_par_seed ~value:(initial + 42));
+  pr "seed changed: %b\n" (seed env <> initial);
+  Env_pool.release pool env;
+  let env' = Env_pool.acquire pool in
+  pr "same environment: %b, seed restored: %b\n" (env == env')
+    (seed env' = initial);
+
+  (* a Gurobi error drops the environment, which is replaced *)
+  failure := Some (Gurobi_error GRB.error_out_of_memory);
+  Env_pool.release pool env';
+  failure := None;
+  let env'' = Env_pool.acquire pool in
+  pr "replaced after a Gurobi error: %b, dropped one freed: %b\n"
+    (env'' != env') (freed env');
+
+  (* other exceptions are raised again, and also drop the environment *)
+  failure := Some Exit;
+  (match Env_pool.release pool env'' with
+  | () -> pr "release: no exception\n"
+  | exception Exit -> pr "release: Exit raised again\n");
+  failure := None;
+  (match Env_pool.try_acquire pool with
+  | Some _ -> pr "dropped environment still idle\n"
+  | None -> pr "no idle environment\n");
+  let env''' = Env_pool.acquire pool in
+  pr "replaced after Exit: %b, dropped one freed: %b\n" (env''' != env'')
+    (freed env'');
+
+  (* environments given back after [close] are freed too *)
+  Env_pool.close pool;
+  Env_pool.release pool env''';
+  pr "given back after close, freed: %b\n" (freed env''')
+
+let () = main ()
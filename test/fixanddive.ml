@@ -1,5 +1,6 @@
 open Guroobi
 open Raw
+open Utils
 open U
 
 type var_t = { index : int; x : float }
@@ -36,33 +37,40 @@ let main () =
       let num_int_vars =
         eer "get_int_attr" (get_int_attr ~model ~name:"NumIntVars")
       in
-      let int_vars = Array.make num_int_vars 0 in
+      let int_vars = i32a num_int_vars in
       let fractional = Array.make num_int_vars { index = 0; x = 0.0 } in
-      let num_fractional = ref 0 in
+      let v_types =
+        eer "get_char_attr_array"
+          (get_char_attr_array ~model ~name:"VType" ~start:0 ~len:num_vars)
+      in
+      (* the integer and binary variables; semi-integer ones, which
+         NumIntVars may count, are left alone *)
+      let num_int = ref 0 in
       for j = 0 to num_vars - 1 do
-        let v_type =
-          eer "get_char_attr_element"
-            (get_char_attr_element ~model ~name:"VType" ~index:j)
-        in
-        if v_type <> GRB.continuous then (
-          int_vars.(!num_fractional) <- j;
-          incr num_fractional;
-          az
-            (set_char_attr_element ~model ~name:"VType" ~index:j
-               ~value:GRB.continuous))
+        if v_types.{j} = GRB.binary || v_types.{j} = GRB.integer then (
+          int_vars.{!num_int} <- Int32.of_int j;
+          incr num_int)
       done;
+      let num_int = !num_int in
+      let continuous = ca num_int in
+      Bigarray.Array1.fill continuous GRB.continuous;
+      az
+        (set_char_attr_list ~model ~name:"VType" ~num:num_int ~ind:int_vars
+           ~values:continuous);
 
       az (optimize model);
 
+      let x = fa num_int in
       let rec for_loop iter =
         let num_fractional = ref 0 in
-        for j = 0 to num_int_vars - 1 do
-          let sol =
-            eer "get_float_attr_element"
-              (get_float_attr_element ~model ~name:"X" ~index:int_vars.(j))
-          in
+        az
+          (get_float_attr_list ~model ~name:"X" ~num:num_int ~ind:int_vars
+             ~values:x);
+        for j = 0 to num_int - 1 do
+          let sol = x.{j} in
           if Float.abs (sol -. Float.floor (sol +. 0.5)) > 1e-5 then (
-            fractional.(!num_fractional) <- { index = int_vars.(j); x = sol };
+            fractional.(!num_fractional) <-
+              { index = Int32.to_int int_vars.{j}; x = sol };
             incr num_fractional)
         done;
 
@@ -75,20 +83,24 @@ let main () =
           let fractional_filled = Array.sub fractional 0 !num_fractional in
           Array.sort vcomp fractional_filled;
           let n_fix = max (!num_fractional / 4) 1 in
+          let fix_ind = i32a n_fix in
+          let fix_val = fa n_fix in
+          for j = 0 to n_fix - 1 do
+            fix_ind.{j} <- Int32.of_int fractional_filled.(j).index;
+            fix_val.{j} <- Float.floor (fractional_filled.(j).x +. 0.5)
+          done;
+          az
+            (set_float_attr_list ~model ~name:"LB" ~num:n_fix ~ind:fix_ind
+               ~values:fix_val);
+          az
+            (set_float_attr_list ~model ~name:"UB" ~num:n_fix ~ind:fix_ind
+               ~values:fix_val);
+          let vnames =
+            eer "get_str_attr_list"
+              (get_str_attr_list ~model ~name:"VarName" ~num:n_fix ~ind:fix_ind)
+          in
           for j = 0 to n_fix - 1 do
-            let fix_val = Float.floor (fractional_filled.(j).x +. 0.5) in
-            az
-              (set_float_attr_element ~model ~name:"LB"
-                 ~index:fractional_filled.(j).index ~value:fix_val);
-            az
-              (set_float_attr_element ~model ~name:"UB"
-                 ~index:fractional_filled.(j).index ~value:fix_val);
-            let vname =
-              eer "get_str_attr_element"
-                (get_str_attr_element ~model ~name:"VarName"
-                   ~index:fractional_filled.(j).index)
-            in
-            pr "  Fix %s to %f ( rel %f )\n" vname fix_val
+            pr "  Fix %s to %f ( rel %f )\n" vnames.(j) fix_val.{j}
               fractional_filled.(j).x
           done;
           az (optimize model);
@@ -0,0 +1,68 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Count the calls made to Gurobi by a few stubs, with instrumentation
+   enabled, then disabled. Not one of Gurobi's examples. *)
+
+let print_stat s ~stub ~name =
+  match Instrument.find s ~stub ~name () with
+  | Some t ->
+      pr "%s %s: %d calls, %d errors, %d in the histogram\n" stub name t.calls
+        t.errors
+        (Array.fold_left ( + ) 0 t.histogram)
+  | None -> pr "%s %s: no calls\n" stub name
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"instrument.log");
+      az (start_env env);
+
+      let model =
+        eer "read_model"
+          (match read_model ~env ~path:"data/stein9.mps" with
+          | FileNotFound ->
+              pr "Error: unable to open input file\n";
+              exit 1
+          | Ok m -> Ok m
+          | Error code -> Error code)
+      in
+
+      Instrument.reset ();
+      Instrument.enable ();
+      pr "enabled: %b\n" (Instrument.enabled ());
+      for index = 0 to 2 do
+        ignore
+          (eer "get_float_attr_element"
+             (get_float_attr_element ~model ~name:GRB.dbl_attr_obj ~index))
+      done;
+      (* an index out of range *)
+      (match get_float_attr_element ~model ~name:GRB.dbl_attr_obj ~index:100 with
+      | Ok _ -> pr "no error\n"
+      | Error _ -> ());
+      let err = i32a 1 in
+      ignore
+        (Fast.get_float_attr_element ~model ~name:GRB.dbl_attr_obj ~index:0 ~err);
+      ignore (eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numvars));
+
+      Instrument.disable ();
+      ignore (eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numvars));
+
+      let s = Instrument.snapshot () in
+      print_stat s ~stub:"gu_get_float_attr_element" ~name:GRB.dbl_attr_obj;
+      print_stat s ~stub:"gu_fast_get_float_attr_element" ~name:GRB.dbl_attr_obj;
+      print_stat s ~stub:"gu_get_int_attr" ~name:GRB.int_attr_numvars;
+      print_stat s ~stub:"gu_optimize" ~name:"";
+      pr "dropped: %d\n" s.dropped;
+
+      Instrument.reset ();
+      pr "after reset: %d stats\n" (List.length (Instrument.snapshot ()).stats)
+
+let () = main ()
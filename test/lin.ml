@@ -0,0 +1,63 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Build the constraints of a small LP with the Lin builder, adding them in
+   blocks of two nonzeros. Not one of Gurobi's examples. *)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"lin.log");
+      az (start_env env);
+
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:(Some "lin") ~num_vars:2
+             ~objective:(Some (to_fa [| 1.0; 2.0 |]))
+             ~lower_bound:None
+             ~upper_bound:(Some (to_fa [| 3.0; 3.0 |]))
+             ~var_type:None ~var_name:None)
+      in
+      az
+        (set_int_attr ~model ~name:GRB.int_attr_modelsense ~value:GRB.maximize);
+
+      let b = Lin.create ~chunk_nz:2 model in
+      (* x0 + x1 + x0 - x0 <= 4 *)
+      Lin.term b 0 1.0;
+      Lin.term b 1 1.0;
+      Lin.term b 0 1.0;
+      Lin.term b 0 (-1.0);
+      Lin.row b GRB.less_equal 4.0;
+      (* x0 - x1 + 1 <= 2 *)
+      Lin.terms b ~num:2 ~ind:(to_i32a [| 0; 1 |])
+        ~value:(to_fa [| 1.0; -1.0 |]);
+      Lin.constant b 1.0;
+      Lin.row b GRB.less_equal 2.0;
+      (* x1 - x1 + x0 <= 2 *)
+      Lin.term b 1 1.0;
+      Lin.term b 1 (-1.0);
+      Lin.term b 0 1.0;
+      Lin.row b GRB.less_equal 2.0;
+      Lin.flush b;
+
+      az (optimize model);
+      let num_constrs =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numconstrs)
+      in
+      let num_nz =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numnzs)
+      in
+      let obj =
+        eer "get_float_attr" (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+      in
+      pr "%d constraints added, %d in the model, %d nonzeros\nobjective: %g\n"
+        (Lin.num_added b) num_constrs num_nz obj
+
+let () = main ()
@@ -0,0 +1,84 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Solve stein9 with presolve, cuts and heuristics off, so that it branches,
+   logging to an in-memory buffer, then parse the node log. Not one of
+   Gurobi's examples. *)
+
+let describe = function
+  | Log.Progress { incumbent; best_bound; gap; elapsed } ->
+      let opt = function None -> "-" | Some x -> sp "%g" x in
+      sp "progress: incumbent %s, bound %s, gap %s, %gs" (opt incumbent)
+        (opt best_bound) (opt gap) elapsed
+  | Summary { objective; bound; final_gap } ->
+      let opt = function None -> "-" | Some x -> sp "%g" x in
+      sp "summary: objective %s, bound %s, gap %s" (opt objective) (opt bound)
+        (opt final_gap)
+  | Explored t -> sp "explored: %gs" t
+  | Other _ -> "other"
+
+let main () =
+  (* lines as Gurobi prints them *)
+  List.iter
+    (fun line -> pr "%s\n" (describe (Log.parse line)))
+    [
+      "     0     0    3.00000    0    9    5.00000    3.00000  40.0%     -    0s";
+      "H    0     0                       5.0000000    3.00000  40.0%     -    0s";
+      "     0     2    3.00000    0    9          -    3.00000      -     -    1s";
+      "Explored 123 nodes (456 simplex iterations) in 0.05 seconds (0.01 work \
+       units)";
+      "Best objective 5.000000000000e+00, best bound 5.000000000000e+00, gap \
+       0.0000%";
+      "Optimize a model with 13 rows, 9 columns and 45 nonzeros";
+    ];
+
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:1);
+      az (set_int_param ~env ~name:GRB.int_par_logtoconsole ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"log.log");
+      az (set_int_param ~env ~name:GRB.int_par_presolve ~value:0);
+      az (set_int_param ~env ~name:GRB.int_par_cuts ~value:0);
+      az (set_float_param ~env ~name:GRB.dbl_par_heuristics ~value:0.0);
+      az (set_int_param ~env ~name:GRB.int_par_threads ~value:1);
+      az (start_env env);
+
+      let buf = log_buffer_create ~capacity:(1 lsl 20) in
+      az (set_log_buffer ~env (Some buf));
+      let model =
+        eer "read_model"
+          (match read_model ~env ~path:"data/stein9.mps" with
+          | FileNotFound ->
+              pr "Error: unable to open input file\n";
+              exit 1
+          | Ok m -> Ok m
+          | Error code -> Error code)
+      in
+      az (optimize model);
+      az (set_log_buffer ~env None);
+
+      let lines = Log.drain buf in
+      let progress =
+        List.filter (function Log.Progress _ -> true | _ -> false) lines
+      in
+      let explored =
+        List.exists (function Log.Explored _ -> true | _ -> false) lines
+      in
+      pr "dropped: %d\n" (log_buffer_dropped buf);
+      pr "node log lines: %b\n" (progress <> []);
+      pr "explored line: %b\n" explored;
+      List.iter
+        (function
+          | Log.Summary { objective = Some obj; _ } ->
+              pr "best objective: %g\n" obj
+          | _ -> ())
+        lines;
+      pr "drained again: %d\n" (List.length (Log.drain buf))
+
+let () = main ()
@@ -0,0 +1,71 @@
+open Guroobi
+open Raw
+open U
+
+(* Marshal stein9, unmarshal it into a second environment, and solve the
+   copy; check that a quadratic model is rejected. Not one of Gurobi's
+   examples. *)
+
+let quiet_env () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"marshal.log");
+      az (start_env env);
+      env
+
+let main () =
+  let env = quiet_env () in
+  let model =
+    eer "read_model"
+      (match read_model ~env ~path:"data/stein9.mps" with
+      | FileNotFound ->
+          pr "Error: unable to open input file\n";
+          exit 1
+      | Ok m -> Ok m
+      | Error code -> Error code)
+  in
+  let bytes = Marshal.to_bytes model [] in
+
+  set_deserialization_env (quiet_env ());
+  let (copy : model) = Marshal.from_bytes bytes 0 in
+  let num_vars =
+    eer "get_int_attr" (get_int_attr ~model:copy ~name:GRB.int_attr_numvars)
+  in
+  let num_constrs =
+    eer "get_int_attr" (get_int_attr ~model:copy ~name:GRB.int_attr_numconstrs)
+  in
+  let name =
+    eer "get_str_attr" (get_str_attr ~model:copy ~name:GRB.str_attr_modelname)
+  in
+  pr "%s: %d variables, %d constraints\n" name num_vars num_constrs;
+  az (optimize copy);
+  let obj =
+    eer "get_float_attr" (get_float_attr ~model:copy ~name:GRB.dbl_attr_objval)
+  in
+  pr "objective: %g\n" obj;
+
+  (* qafiro has a quadratic objective, which marshaling would lose *)
+  let qafiro =
+    eer "read_model"
+      (match read_model ~env ~path:"data/qafiro.mps" with
+      | FileNotFound ->
+          pr "Error: unable to open input file\n";
+          exit 1
+      | Ok m -> Ok m
+      | Error code -> Error code)
+  in
+  let code = marshal_check qafiro in
+  pr "qafiro: %s\n"
+    (if code = GRB.error_not_supported then "not supported"
+     else string_of_int code);
+  let bytes = Marshal.to_bytes qafiro [] in
+  match (Marshal.from_bytes bytes 0 : model) with
+  | _ -> pr "qafiro: unmarshaled\n"
+  | exception Failure _ -> pr "qafiro: unmarshaling failed\n"
+
+let () = main ()
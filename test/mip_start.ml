@@ -0,0 +1,72 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Fill two MIP starts with set_mip_start, densely and sparsely, and read
+   them back through the StartNumber parameter. Not one of Gurobi's
+   examples. *)
+
+let print_start model start_number =
+  az (set_int_model_param ~model ~name:GRB.int_par_startnumber ~value:start_number);
+  let start =
+    eer "get_float_attr_array"
+      (get_float_attr_array ~model ~name:GRB.dbl_attr_start ~start:0 ~len:3)
+  in
+  pr "start %d:" start_number;
+  Bigarray.Array1.iter
+    (fun x -> if x = GRB.undefined then pr " undefined" else pr " %g" x)
+    start;
+  pr "\n"
+
+let start_number model =
+  eer "get_int_model_param"
+    (get_int_model_param ~model ~name:GRB.int_par_startnumber)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"mip_start.log");
+      az (start_env env);
+
+      let var_type = ca 3 in
+      Bigarray.Array1.fill var_type GRB.binary;
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:(Some "mip_start") ~num_vars:3 ~objective:None
+             ~lower_bound:None ~upper_bound:None ~var_type:(Some var_type)
+             ~var_name:None)
+      in
+
+      (* start 0, dense *)
+      az
+        (set_mip_start ~model ~start_number:0 ~num:3 ~ind:None
+           ~values:(to_fa [| 1.0; 0.0; 1.0 |]));
+      (* start 1, sparse: NumStart grows, and variable 1 is left undefined *)
+      az
+        (set_mip_start ~model ~start_number:1 ~num:2
+           ~ind:(Some (to_i32a [| 2; 0 |]))
+           ~values:(to_fa [| 0.0; 1.0 |]));
+      az (update_model ~model);
+      pr "NumStart: %d\n"
+        (eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numstart));
+      pr "StartNumber restored: %d\n" (start_number model);
+      print_start model 0;
+      print_start model 1;
+
+      (* a StartNumber other than 0 is restored too *)
+      az
+        (set_mip_start ~model ~start_number:0 ~num:1
+           ~ind:(Some (to_i32a [| 1 |]))
+           ~values:(to_fa [| 1.0 |]));
+      az (update_model ~model);
+      pr "StartNumber restored: %d\n" (start_number model);
+      print_start model 0;
+      print_start model 1
+
+let () = main ()
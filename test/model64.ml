@@ -0,0 +1,97 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Build a small LP through the 64-bit variants of add_vars, add_constrs and
+   chg_coeffs. Not one of Gurobi's examples. *)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"model64.log");
+      az (start_env env);
+
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:(Some "model64") ~num_vars:0 ~objective:None
+             ~lower_bound:None ~upper_bound:None ~var_type:None ~var_name:None)
+      in
+      az
+        (set_int_attr ~model ~name:GRB.int_attr_modelsense ~value:GRB.maximize);
+
+      (* x and y, without nonzeros *)
+      az
+        (add_vars64 ~model ~num_vars:2 ~matrix:None
+           ~objective:(Some (to_fa [| 1.0; 1.0 |]))
+           ~lower_bound:None ~upper_bound:None ~var_type:None
+           ~name:(Some [| "x"; "y" |]));
+
+      (* x + 2 y <= 4, 3 x + y <= 6 *)
+      let rows : compressed64 =
+        {
+          num_nz = 4;
+          xbeg = to_i64a [| 0; 2 |];
+          xind = to_i32a [| 0; 1; 0; 1 |];
+          xval = to_fa [| 1.0; 2.0; 3.0; 1.0 |];
+        }
+      in
+      let sense = to_ca [| GRB.less_equal; GRB.less_equal |] in
+      let rhs = to_fa [| 4.0; 6.0 |] in
+      az
+        (add_constrs64 ~model ~num:2 ~matrix:(Some rows) ~sense ~rhs
+           ~name:None);
+
+      (* z <= 1, in both constraints *)
+      let column : compressed64 =
+        {
+          num_nz = 2;
+          xbeg = to_i64a [| 0 |];
+          xind = to_i32a [| 0; 1 |];
+          xval = to_fa [| 1.0; 1.0 |];
+        }
+      in
+      az
+        (add_vars64 ~model ~num_vars:1 ~matrix:(Some column)
+           ~objective:(Some (to_fa [| 1.0 |]))
+           ~lower_bound:None
+           ~upper_bound:(Some (to_fa [| 1.0 |]))
+           ~var_type:None ~name:(Some [| "z" |]));
+
+      (* 3 x becomes 2 x in the second constraint *)
+      az
+        (chg_coeffs64 ~model ~num_chgs:1 ~c_ind:(to_i32a [| 1 |])
+           ~v_ind:(to_i32a [| 0 |]) ~value:(to_fa [| 2.0 |]));
+
+      (* begin offsets that decrease, or are negative, are rejected *)
+      List.iter
+        (fun beg ->
+          let bad : compressed64 = { rows with xbeg = to_i64a beg } in
+          match
+            add_constrs64 ~model ~num:2 ~matrix:(Some bad) ~sense ~rhs
+              ~name:None
+          with
+          | _ -> pr "begin offsets accepted\n"
+          | exception Invalid_argument msg -> pr "%s\n" msg)
+        [ [| 2; 0 |]; [| -1; 2 |] ];
+
+      az (optimize model);
+      let num_vars =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numvars)
+      in
+      let num_constrs =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numconstrs)
+      in
+      let coeff = eer "get_coeff" (get_coeff ~model ~constr:1 ~var:0) in
+      let obj =
+        eer "get_float_attr" (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+      in
+      pr "%d variables, %d constraints, coefficient %g\nobjective: %g\n"
+        num_vars num_constrs coeff obj
+
+let () = main ()
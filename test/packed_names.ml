@@ -0,0 +1,85 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Build a model with the packed builders, including an empty name, read the
+   names back packed, and check that malformed tables are rejected. Not one of
+   Gurobi's examples. *)
+
+let print_names label names =
+  pr "%s:" label;
+  Array.iter (fun s -> pr " %S" s) (unpack_names names);
+  pr "\n"
+
+let rejected label f =
+  match f () with
+  | _ -> pr "%s: accepted\n" label
+  | exception Invalid_argument _ -> pr "%s: rejected\n" label
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az
+        (set_str_param ~env ~name:GRB.str_par_logfile
+           ~value:"packed_names.log");
+      az (start_env env);
+
+      let model =
+        eer "new_model_packed"
+          (new_model_packed ~env ~name:(Some "packed") ~num_vars:2
+             ~objective:None ~lower_bound:None ~upper_bound:None ~var_type:None
+             ~var_name:(Some (pack_names [| "x"; "" |])))
+      in
+      az
+        (add_vars_packed ~model ~num_vars:1 ~matrix:None ~objective:None
+           ~lower_bound:None ~upper_bound:None ~var_type:None
+           ~name:(Some (pack_names [| "z" |])));
+      let sense = ca 2 in
+      Bigarray.Array1.fill sense GRB.less_equal;
+      az
+        (add_constrs_packed ~model ~num:2 ~matrix:None ~sense
+           ~rhs:(to_fa [| 1.0; 2.0 |])
+           ~name:(Some (pack_names [| "c0"; "c1" |])));
+      az (update_model ~model);
+
+      print_names "variables"
+        (eer "get_str_attr_array_packed"
+           (get_str_attr_array_packed ~model ~name:GRB.str_attr_varname
+              ~start:0 ~len:3));
+      print_names "constraints"
+        (eer "get_str_attr_array_packed"
+           (get_str_attr_array_packed ~model ~name:GRB.str_attr_constrname
+              ~start:0 ~len:2));
+
+      (* the last name is not terminated *)
+      let unterminated =
+        let names = pack_names [| "a"; "b" |] in
+        {
+          names with
+          data =
+            Bigarray.Array1.sub names.data 0
+              (Bigarray.Array1.dim names.data - 1);
+        }
+      in
+      (* an offset past the end of the data *)
+      let out_of_range =
+        let names = pack_names [| "a"; "b" |] in
+        names.offsets.{1} <- 100l;
+        names
+      in
+      let add name =
+        add_constrs_packed ~model ~num:2 ~matrix:None ~sense
+          ~rhs:(to_fa [| 1.0; 2.0 |])
+          ~name:(Some name)
+      in
+      rejected "unterminated" (fun () -> add unterminated);
+      rejected "out of range" (fun () -> add out_of_range);
+      rejected "unpack out of range" (fun () -> unpack_names out_of_range)
+
+let () = main ()
@@ -0,0 +1,67 @@
+open Guroobi
+open Raw
+open U
+
+(* The model of qp.ml, with its objective built by the Quad builder from
+   terms that are split, reversed and cancelling. Not one of Gurobi's
+   examples.
+
+   minimize x^2 + x y + y^2 + y z + z^2 + 2 x
+   subject to x + 2 y + 3 z >= 4, x + y >= 1 *)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"quad.log");
+      az (start_env env);
+
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:(Some "quad") ~num_vars:3 ~objective:None
+             ~lower_bound:None ~upper_bound:None ~var_type:None ~var_name:None)
+      in
+
+      let q = Quad.create model in
+      Quad.qterm q 0 0 0.5;
+      Quad.qterm q 0 0 0.5;
+      Quad.qterm q 1 0 0.5;
+      Quad.qterm q 0 1 0.5;
+      Quad.qterm q 1 1 1.0;
+      Quad.qterm q 2 1 1.0;
+      Quad.qterm q 2 2 1.0;
+      Quad.qterm q 0 2 1.0;
+      Quad.qterm q 2 0 (-1.0);
+      Quad.term q 0 1.0;
+      Quad.term q 0 1.0;
+      Quad.objective q;
+
+      let b = Lin.create model in
+      Lin.term b 0 1.0;
+      Lin.term b 1 2.0;
+      Lin.term b 2 3.0;
+      Lin.row b GRB.greater_equal 4.0;
+      Lin.term b 0 1.0;
+      Lin.term b 1 1.0;
+      Lin.row b GRB.greater_equal 1.0;
+      Lin.flush b;
+
+      az (optimize model);
+      let num_qnz =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numqnzs)
+      in
+      let obj_val =
+        eer "get_float_attr" (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+      in
+      let sol =
+        eer "get_float_attr_array"
+          (get_float_attr_array ~model ~name:GRB.dbl_attr_x ~start:0 ~len:3)
+      in
+      pr "quadratic terms: %d\nobj: %.4e\nx=%.4f\ny=%.4f\nz=%.4f\n" num_qnz
+        obj_val sol.{0} sol.{1} sol.{2}
+
+let () = main ()
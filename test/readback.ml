@@ -0,0 +1,98 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Read the constraint matrix of stein9 back, by constraints and by
+   variables, and check the two agree. Not one of Gurobi's examples. *)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"readback.log");
+      az (start_env env);
+
+      let model =
+        eer "read_model"
+          (match read_model ~env ~path:"data/stein9.mps" with
+          | FileNotFound ->
+              pr "Error: unable to open input file\n";
+              exit 1
+          | Ok m -> Ok m
+          | Error code -> Error code)
+      in
+      let num_vars =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numvars)
+      in
+      let num_constrs =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_numconstrs)
+      in
+      let var_names =
+        eer "get_str_attr_array_packed"
+          (get_str_attr_array_packed ~model ~name:GRB.str_attr_varname ~start:0
+             ~len:num_vars)
+      in
+      let constr_names =
+        eer "get_str_attr_array_packed"
+          (get_str_attr_array_packed ~model ~name:GRB.str_attr_constrname
+             ~start:0 ~len:num_constrs)
+      in
+
+      (* by constraints *)
+      let num_nz =
+        eer "get_constrs_nz"
+          (get_constrs_nz ~model ~start:0 ~len:num_constrs)
+      in
+      let rows =
+        { num_nz; xbeg = i32a num_constrs; xind = i32a num_nz; xval = fa num_nz }
+      in
+      let n =
+        eer "get_constrs"
+          (get_constrs ~model ~start:0 ~len:num_constrs ~dst:rows)
+      in
+      pr "%d constraints, %d variables, %d nonzeros\n" num_constrs num_vars n;
+      for i = 0 to num_constrs - 1 do
+        let first = Int32.to_int rows.xbeg.{i} in
+        let last = if i + 1 < num_constrs then Int32.to_int rows.xbeg.{i + 1} else n in
+        let vars =
+          List.init (last - first) (fun p -> Int32.to_int rows.xind.{first + p})
+          |> List.sort compare
+        in
+        pr "%s:" (packed_name constr_names i);
+        List.iter (fun j -> pr " %s" (packed_name var_names j)) vars;
+        pr "\n"
+      done;
+
+      (* by variables, for a range of them, with 64-bit offsets *)
+      let start = 3 and len = 3 in
+      let num_nz =
+        eer "get_vars_nz" (get_vars_nz ~model ~start ~len)
+      in
+      let cols : compressed64 =
+        { num_nz; xbeg = i64a len; xind = i32a num_nz; xval = fa num_nz }
+      in
+      let n = eer "get_vars64" (get_vars64 ~model ~start ~len ~dst:cols) in
+      let agree = ref true in
+      for q = 0 to len - 1 do
+        let first = Int64.to_int cols.xbeg.{q} in
+        let last = if q + 1 < len then Int64.to_int cols.xbeg.{q + 1} else n in
+        for p = first to last - 1 do
+          let constr = Int32.to_int cols.xind.{p} in
+          let coeff =
+            eer "get_coeff" (get_coeff ~model ~constr ~var:(start + q))
+          in
+          if coeff <> cols.xval.{p} then agree := false
+        done
+      done;
+      pr "variables %d to %d: %d nonzeros, agree with get_coeff: %b\n" start
+        (start + len - 1) n !agree;
+      let zero = eer "get_coeff" (get_coeff ~model ~constr:0 ~var:0) in
+      pr "coefficient of %s in %s: %g\n" (packed_name var_names 0)
+        (packed_name constr_names 0) zero
+
+let () = main ()
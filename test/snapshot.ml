@@ -0,0 +1,62 @@
+open Guroobi
+open Raw
+open U
+
+(* Save stein9 as a snapshot, map it back, and solve the model loaded from
+   it. Not one of Gurobi's examples. *)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"snapshot.log");
+      az (start_env env);
+
+      let original =
+        eer "read_model"
+          (match read_model ~env ~path:"data/stein9.mps" with
+          | FileNotFound ->
+              pr "Error: unable to open input file\n";
+              exit 1
+          | Ok m -> Ok m
+          | Error code -> Error code)
+      in
+      let path = Filename.temp_file "stein9" ".snapshot" in
+      eer "Snapshot.save" (Snapshot.save original path);
+
+      let s = Snapshot.open_file path in
+      pr "snapshot: %d variables, %d constraints, %d nonzeros\n" s.num_vars
+        s.num_constrs s.matrix.num_nz;
+      let model = eer "Snapshot.load" (Snapshot.load ~env s) in
+      az (optimize model);
+      let obj =
+        eer "get_float_attr" (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+      in
+      let name =
+        eer "get_str_attr_element"
+          (get_str_attr_element ~model ~name:GRB.str_attr_varname ~index:8)
+      in
+      pr "objective: %g\nlast variable: %s\n" obj name;
+
+      (* qafiro has a quadratic objective, which a snapshot cannot hold *)
+      let qafiro =
+        eer "read_model"
+          (match read_model ~env ~path:"data/qafiro.mps" with
+          | FileNotFound ->
+              pr "Error: unable to open input file\n";
+              exit 1
+          | Ok m -> Ok m
+          | Error code -> Error code)
+      in
+      (match Snapshot.save qafiro path with
+      | Error code when code = GRB.error_not_supported ->
+          pr "qafiro: not supported\n"
+      | Error code -> ee "Snapshot.save" code
+      | Ok () -> pr "qafiro: saved\n");
+      Sys.remove path
+
+let () = main ()
@@ -0,0 +1,104 @@
+open Guroobi
+open Utils
+open U
+
+(* Assemble a small matrix with duplicate entries from COO triples, and merge
+   symmetric triples; check that a large assembly gives the same result on 1
+   and 4 threads. Not one of Gurobi's examples. *)
+
+let print_i32a label a =
+  pr "%s:" label;
+  Bigarray.Array1.iter (fun x -> pr " %ld" x) a;
+  pr "\n"
+
+let print_fa label a =
+  pr "%s:" label;
+  Bigarray.Array1.iter (fun x -> pr " %g" x) a;
+  pr "\n"
+
+let () =
+  (* [ 1 0 2 ]
+     [ 0 0 0 ]
+     [ 3 4 0 ], with entry (0, 2) given as 1.5 + 0.5 *)
+  let row = to_i32a [| 2; 0; 0; 2; 0 |] in
+  let col = to_i32a [| 1; 2; 0; 0; 2 |] in
+  let value = to_fa [| 4.; 1.5; 1.; 3.; 0.5 |] in
+  List.iter
+    (fun merge ->
+      let m =
+        Sparse.to_csr ~threads:2 ~merge ~num_rows:3 ~num_cols:3 ~num:5 ~row
+          ~col ~value ()
+      in
+      pr "merge %b, %d nonzeros\n" merge m.num_nz;
+      print_i32a "xbeg" m.xbeg;
+      print_i32a "xind" m.xind;
+      print_fa "xval" m.xval)
+    [ false; true ];
+  let m =
+    Sparse.to_csc64 ~merge:true ~num_rows:3 ~num_cols:3 ~num:5 ~row ~col
+      ~value ()
+  in
+  pr "by columns: %d nonzeros\n" m.num_nz;
+  Bigarray.Array1.iter (fun x -> pr " %Ld" x) m.xbeg;
+  pr "\n";
+  print_i32a "xind" m.xind;
+  print_fa "xval" m.xval;
+
+  (* x0 x1 + x1 x0 + x1^2 - x1^2 *)
+  let row = to_i32a [| 0; 1; 1; 1 |] in
+  let col = to_i32a [| 1; 0; 1; 1 |] in
+  let value = to_fa [| 1.; 1.; 1.; -1. |] in
+  let n = Sparse.coo_coalesce ~num:4 ~row ~col ~value ~symmetric:true in
+  pr "coalesced: %d" n;
+  for k = 0 to n - 1 do
+    pr " (%ld, %ld, %g)" row.{k} col.{k} value.{k}
+  done;
+  pr "\n";
+
+  (* an out-of-range column is rejected, with or without merging *)
+  List.iter
+    (fun merge ->
+      match
+        Sparse.to_csr ~merge ~num_rows:3 ~num_cols:2 ~num:3
+          ~row:(to_i32a [| 2; 0; 0 |])
+          ~col:(to_i32a [| 1; 2; 0 |])
+          ~value:(to_fa [| 1.; 1.; 1. |])
+          ()
+      with
+      | _ -> pr "merge %b: column 2 of 2 accepted\n" merge
+      | exception Invalid_argument _ ->
+          pr "merge %b: column 2 of 2 rejected\n" merge)
+    [ false; true ];
+
+  (* above GU_SPARSE_PARALLEL_MIN entries, with duplicates; the values are
+     integers, so that sums do not depend on their order *)
+  let num = 1 lsl 17 and num_rows = 500 and num_cols = 300 in
+  let seed = ref 12345 in
+  let next bound =
+    seed := (!seed * 1103515245 + 12345) land 0x7fffffff;
+    (!seed lsr 8) mod bound
+  in
+  let row = Utils.i32a num and col = Utils.i32a num and value = Utils.fa num in
+  let pairs = Hashtbl.create num in
+  for k = 0 to num - 1 do
+    let r = next num_rows and c = next num_cols in
+    row.{k} <- Int32.of_int r;
+    col.{k} <- Int32.of_int c;
+    value.{k} <- float (next 7 - 3);
+    Hashtbl.replace pairs (r, c) ()
+  done;
+  List.iter
+    (fun merge ->
+      let csr threads =
+        Sparse.to_csr ~threads ~merge ~num_rows ~num_cols ~num ~row ~col ~value
+          ()
+      in
+      let a = csr 1 and b = csr 4 in
+      pr "%d entries, merge %b: threads 1 and 4 agree: %b, %s nonzeros\n" num
+        merge
+        (a.num_nz = b.num_nz && a.xbeg = b.xbeg && a.xind = b.xind
+       && a.xval = b.xval)
+        (if a.num_nz = if merge then Hashtbl.length pairs else num then
+           "expected"
+         else "unexpected"))
+    [ false; true ]
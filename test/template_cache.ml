@@ -0,0 +1,86 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Solve variants of a small LP, obtained as clones of a cached template with
+   different right-hand sides and bounds. Not one of Gurobi's examples.
+
+   maximize x + 2 y subject to x + y <= 4, with 0 <= x, y <= 3 *)
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az
+        (set_str_param ~env ~name:GRB.str_par_logfile
+           ~value:"template_cache.log");
+      az (start_env env);
+
+      let base =
+        eer "new_model"
+          (new_model ~env ~name:(Some "base") ~num_vars:2
+             ~objective:(Some (to_fa [| 1.0; 2.0 |]))
+             ~lower_bound:None
+             ~upper_bound:(Some (to_fa [| 3.0; 3.0 |]))
+             ~var_type:None ~var_name:None)
+      in
+      az
+        (set_int_attr ~model:base ~name:GRB.int_attr_modelsense
+           ~value:GRB.maximize);
+      az
+        (add_constr ~model:base ~num_nz:2 ~var_index:(to_i32a [| 0; 1 |])
+           ~nz:(to_fa [| 1.0; 1.0 |]) ~sense:GRB.less_equal ~rhs:4.0
+           ~name:(Some "c0"));
+
+      let cache = Template_cache.create () in
+      Template_cache.register cache ~name:"lp" ~version:1 base;
+
+      let solve label deltas =
+        Template_cache.with_clone cache ~name:"lp" deltas (fun model ->
+            az (optimize model);
+            let obj =
+              eer "get_float_attr"
+                (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+            in
+            pr "%s: %g\n" label obj)
+      in
+      let rhs v =
+        {
+          Template_cache.attr = GRB.dbl_attr_rhs;
+          ind = to_i32a [| 0 |];
+          values = to_fa [| v |];
+        }
+      in
+      let ub i v =
+        {
+          Template_cache.attr = GRB.dbl_attr_ub;
+          ind = to_i32a [| i |];
+          values = to_fa [| v |];
+        }
+      in
+      solve "base" [];
+      solve "rhs 2" [ rhs 2.0 ];
+      (* the clone released above is reused, with the base right-hand side *)
+      solve "ub y 1" [ ub 1 1.0 ];
+      solve "rhs 5, ub x 1" [ rhs 5.0; ub 0 1.0 ];
+      solve "base again" [];
+
+      (* a clone with an added constraint is not reused *)
+      Template_cache.with_clone cache ~name:"lp" [] (fun model ->
+          az
+            (add_constr ~model ~num_nz:1 ~var_index:(to_i32a [| 1 |])
+               ~nz:(to_fa [| 1.0 |]) ~sense:GRB.less_equal ~rhs:1.0
+               ~name:(Some "c1"));
+          az (optimize model);
+          let obj =
+            eer "get_float_attr" (get_float_attr ~model ~name:GRB.dbl_attr_objval)
+          in
+          pr "y <= 1: %g\n" obj);
+      solve "base after y <= 1" []
+
+let () = main ()
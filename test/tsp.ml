@@ -0,0 +1,186 @@
+open Guroobi
+open Raw
+open Utils
+open U
+
+(* Solve a traveling salesman problem on a set of points using lazy
+   constraints. The base MIP model only includes 'degree-2' constraints,
+   requiring each node to have exactly two incident edges. Solutions to this
+   model may contain subtours - tours that don't visit every node. The lazy
+   constraint callback adds new constraints to cut them off.
+
+   Unlike the original example, which uses randomly generated points, the
+   points lie on a circle, in scrambled order, so that the optimal tour is
+   known in advance. Also, the callback cuts off all the subtours of a
+   solution at once, rather than only the shortest one. *)
+
+let n = 17
+
+(* node [i] is at angle [2 pi k / n], where [k = 7 i mod n] *)
+let x = Array.init n (fun i -> cos (2.0 *. Float.pi *. float (7 * i mod n) /. float n))
+let y = Array.init n (fun i -> sin (2.0 *. Float.pi *. float (7 * i mod n) /. float n))
+
+let distance i j =
+  let dx = x.(i) -. x.(j) in
+  let dy = y.(i) -. y.(j) in
+  sqrt ((dx *. dx) +. (dy *. dy))
+
+(* Given an integer-feasible solution [sol], find the subtours it consists of,
+   each subtour being listed in the order its nodes are visited, starting from
+   its lowest-numbered node. *)
+let find_subtours sol =
+  let seen = Array.make n false in
+  let rec follow node tour =
+    seen.(node) <- true;
+    let rec next i =
+      if i = n then None
+      else if sol.{(node * n) + i} > 0.5 && not seen.(i) then Some i
+      else next (i + 1)
+    in
+    match next 0 with
+    | Some i -> follow i (i :: tour)
+    | None -> Array.of_list (List.rev tour)
+  in
+  let rec subtours start acc =
+    if start = n then List.rev acc
+    else if seen.(start) then subtours (start + 1) acc
+    else subtours (start + 1) (follow start [ start ] :: acc)
+  in
+  subtours 0 []
+
+(* Subtour elimination callback. Whenever a feasible solution is found, add a
+   subtour elimination constraint for each of its subtours, if it does not
+   consist of a single tour. *)
+let subtour_elim sol ctx ~where =
+  if where = GRB.cb_mipsol then (
+    az (cb_get_solution ctx ~what:GRB.cb_mipsol_sol ~dst:sol);
+    match find_subtours sol with
+    | [ _ ] -> ()
+    | subtours ->
+        let num = List.length subtours in
+        let num_nz =
+          List.fold_left
+            (fun nz tour ->
+              let len = Array.length tour in
+              nz + (len * (len - 1) / 2))
+            0 subtours
+        in
+        let xbeg = i32a num in
+        let xind = i32a num_nz in
+        let xval = fa num_nz in
+        let sense = ca num in
+        let rhs = fa num in
+        let nz = ref 0 in
+        List.iteri
+          (fun k tour ->
+            let len = Array.length tour in
+            xbeg.{k} <- Int32.of_int !nz;
+            for i = 0 to len - 1 do
+              for j = i + 1 to len - 1 do
+                xind.{!nz} <- Int32.of_int ((tour.(i) * n) + tour.(j));
+                xval.{!nz} <- 1.0;
+                incr nz
+              done
+            done;
+            sense.{k} <- GRB.less_equal;
+            rhs.{k} <- float (len - 1))
+          subtours;
+        az
+          (cb_lazy ctx ~num ~matrix:{ num_nz; xbeg; xind; xval } ~sense ~rhs))
+
+let main () =
+  let env = eer "empty_env" (empty_env ()) in
+  match Params.read_and_set env with
+  | Error msg ->
+      print_endline msg;
+      exit 1
+  | Ok () ->
+      az (set_int_param ~env ~name:GRB.int_par_outputflag ~value:0);
+      az (set_str_param ~env ~name:GRB.str_par_logfile ~value:"tsp.log");
+      az (start_env env);
+
+      (* Create an empty model *)
+      let model =
+        eer "new_model"
+          (new_model ~env ~name:(Some "tsp") ~num_vars:0 ~objective:None
+             ~lower_bound:None ~upper_bound:None ~var_type:None ~var_name:None)
+      in
+
+      (* Add variables - one for every pair of nodes *)
+      let num_vars = n * n in
+      let obj = fa num_vars in
+      let var_type = ca num_vars in
+      let names = Array.make num_vars "" in
+      for i = 0 to n - 1 do
+        for j = 0 to n - 1 do
+          obj.{(i * n) + j} <- distance i j;
+          var_type.{(i * n) + j} <- GRB.binary;
+          names.((i * n) + j) <- sp "x_%d_%d" i j
+        done
+      done;
+      az
+        (add_vars ~model ~num_vars ~matrix:None ~objective:(Some obj)
+           ~lower_bound:None ~upper_bound:None ~var_type:(Some var_type)
+           ~name:(Some names));
+
+      (* Degree-2 constraints *)
+      let var_index = i32a n in
+      let nz = fa n in
+      for i = 0 to n - 1 do
+        for j = 0 to n - 1 do
+          var_index.{j} <- Int32.of_int ((i * n) + j);
+          nz.{j} <- 1.0
+        done;
+        az
+          (add_constr ~model ~num_nz:n ~var_index ~nz ~sense:GRB.equal ~rhs:2.0
+             ~name:(Some (sp "deg2_%d" i)))
+      done;
+
+      (* Forbid edge from node back to itself *)
+      for i = 0 to n - 1 do
+        az
+          (set_float_attr_element ~model ~name:GRB.dbl_attr_ub
+             ~index:((i * n) + i) ~value:0.0)
+      done;
+
+      (* Symmetric TSP *)
+      for i = 0 to n - 1 do
+        for j = 0 to i - 1 do
+          let var_index = to_i32a [| (i * n) + j; i + (j * n) |] in
+          let nz = to_fa [| 1.0; -1.0 |] in
+          az
+            (add_constr ~model ~num_nz:2 ~var_index ~nz ~sense:GRB.equal
+               ~rhs:0.0 ~name:None)
+        done
+      done;
+
+      (* Set callback function *)
+      az
+        (set_int_model_param ~model ~name:GRB.int_par_lazyconstraints ~value:1);
+      let sol = fa num_vars in
+      az
+        (set_callback_func ~model ~wheres:(Some [ GRB.cb_mipsol ])
+           (Some (subtour_elim sol)));
+
+      (* Optimize model *)
+      az (optimize model);
+      az (set_callback_func ~model ~wheres:None None);
+
+      (* Extract solution *)
+      let sol_count =
+        eer "get_int_attr" (get_int_attr ~model ~name:GRB.int_attr_solcount)
+      in
+      if sol_count > 0 then (
+        let sol =
+          eer "get_float_attr_array"
+            (get_float_attr_array ~model ~name:GRB.dbl_attr_x ~start:0
+               ~len:num_vars)
+        in
+        match find_subtours sol with
+        | [ tour ] ->
+            pr "Tour: %s\n"
+              (String.concat " " (Array.to_list (Array.map string_of_int tour)))
+        | _ -> pr "Solution contains subtours\n")
+      else pr "No solution found\n"
+
+let () = main ()